@@ -1865,7 +1865,8 @@ compiling :-
     reexport(:),
     reexport(:, +),
     load_files(:),
-    load_files(:, +).
+    load_files(:, +),
+    load_data_file(:, +).
 
 %!  ensure_loaded(+FileOrListOfFiles)
 %
@@ -1964,7 +1965,10 @@ load_files(Module:Files, Options) :-
     List = [_|_],
     !,
     '$must_be'(list, List),
-    '$load_file_list'(List, Module, Options).
+    (   '$concurrent_load'(List, Options, Threads)
+    ->  '$concurrent_load_file_list'(List, Module, Threads, Options)
+    ;   '$load_file_list'(List, Module, Options)
+    ).
 '$load_files'(File, Module, Options) :-
     '$load_one_file'(File, Module, Options).
 
@@ -1975,6 +1979,204 @@ load_files(Module:Files, Options) :-
           '$print_message'(error, E)),
     '$load_file_list'(Rest, Module, Options).
 
+%!  '$concurrent_load'(+Files, +Options, -Threads) is semidet.
+%
+%   True when Files must be loaded using Threads worker threads. This
+%   requires the option threads(Count) and is not done if we are
+%   loading a file, as the load context of the workers would not
+%   reflect the file from which Files are loaded.
+
+'$concurrent_load'(List, Options, Threads) :-
+    '$option'(threads(Count), Options),
+    '$must_be'(between(1, inf), Count),
+    current_prolog_flag(threads, true),
+    \+ source_location(_, _),
+    length(List, Len),
+    Threads is min(Count, Len),
+    Threads > 1.
+
+%!  '$concurrent_load_file_list'(+Files, +Module, +Threads, +Options)
+%
+%   Load Files using a pool of Threads workers that fetch files from a
+%   queue. Errors are printed as in '$load_file_list'/3. Other
+%   exceptions are re-thrown after all workers have completed. As with
+%   '$load_file_list'/3, we fail if loading a file fails. The worker
+%   that loaded this file stops, leaving the remaining files to the
+%   other workers.
+
+'$concurrent_load_file_list'(List, Module, Threads, Options) :-
+    setup_call_cleanup(
+        message_queue_create(Queue),
+        ( forall('$member'(File, List),
+                 thread_send_message(Queue, file(File))),
+          forall(between(1, Threads, _),
+                 thread_send_message(Queue, done)),
+          findall('$load_file_worker'(Queue, Module, Options),
+                  between(1, Threads, _), Goals),
+          '$create_load_workers'(Goals, Ids),
+          '$join_load_workers'(Ids, Statuses)
+        ),
+        message_queue_destroy(Queue)),
+    (   '$member'(exception(E), Statuses)
+    ->  throw(E)
+    ;   '$member'(false, Statuses)
+    ->  fail
+    ;   true
+    ).
+
+'$load_file_worker'(Queue, Module, Options) :-
+    thread_get_message(Queue, Msg),
+    (   Msg = file(File)
+    ->  E = error(_,_),
+        catch('$load_one_file'(File, Module, Options), E,
+              '$print_message'(error, E)),
+        '$load_file_worker'(Queue, Module, Options)
+    ;   true
+    ).
+
+%!  '$create_load_workers'(+Goals, -Ids) is det.
+%
+%   Create a thread for each of Goals. If creating a thread raises an
+%   exception, the threads created so far are joined before the
+%   exception is re-thrown.
+
+'$create_load_workers'(Goals, Ids) :-
+    '$create_load_workers'(Goals, [], Ids).
+
+'$create_load_workers'([], Ids0, Ids) :-
+    '$reverse'(Ids0, Ids).
+'$create_load_workers'([Goal|Goals], Ids0, Ids) :-
+    catch(thread_create(Goal, Id, []), E,
+          ( '$join_load_workers'(Ids0, _),
+            throw(E)
+          )),
+    '$create_load_workers'(Goals, [Id|Ids0], Ids).
+
+%!  '$join_load_workers'(+Ids, -Statuses) is det.
+%
+%   Join the threads Ids. Statuses is  a  list   of  the  status of the
+%   threads that did not succeed.
+
+'$join_load_workers'([], []).
+'$join_load_workers'([Id|Ids], Statuses) :-
+    thread_join(Id, Status),
+    (   Status == true
+    ->  Statuses = Rest
+    ;   Statuses = [Status|Rest]
+    ),
+    '$join_load_workers'(Ids, Rest).
+
+
+%!  load_data_file(:File, +Options) is det.
+%
+%   Add the clauses of File to the module using assertz/1. File may
+%   only contain clauses, typically facts. It is split at clause
+%   boundaries into chunks that are read by a pool of threads, after
+%   which the clauses are added in their original order. Options:
+%
+%     - threads(+Count)
+%       Use at most Count threads. Default is the Prolog flag
+%       `cpu_count`.
+%     - data_only(+Bool)
+%       Passed to read_term/3.
+
+load_data_file(Module:Spec, Options) :-
+    '$must_be'(list, Options),
+    absolute_file_name(Spec, File,
+                       [ file_type(prolog),
+                         access(read)
+                       ]),
+    (   '$option'(threads(Count), Options)
+    ->  '$must_be'(between(1, inf), Count)
+    ;   current_prolog_flag(cpu_count, Count)
+    ),
+    (   current_prolog_flag(threads, true)
+    ->  Parts = Count
+    ;   Parts = 1
+    ),
+    '$option'(data_only(DataOnly), Options, false),
+    ReadOptions = [module(Module), data_only(DataOnly)],
+    '$clause_boundaries'(File, Parts, Offsets),
+    (   Offsets = [From, To]
+    ->  '$read_data_chunk'(File, From, To, ReadOptions, Clauses),
+        '$assert_data'(Clauses, Module)
+    ;   '$concurrent_load_data'(File, Offsets, Module, ReadOptions)
+    ).
+
+%!  '$concurrent_load_data'(+File, +Offsets, +Module, +ReadOptions)
+%
+%   Read each chunk of File delimited by Offsets in its own thread.
+%   The chunks are received in order from a queue and added to Module
+%   while later chunks are still being read.
+
+'$concurrent_load_data'(File, Offsets, Module, ReadOptions) :-
+    setup_call_cleanup(
+        message_queue_create(Queue),
+        ( findall('$data_chunk_worker'(Queue, I, File, From, To,
+                                       ReadOptions),
+                  '$data_chunk'(Offsets, 1, I, From, To),
+                  Goals),
+          '$create_load_workers'(Goals, Ids),
+          length(Ids, Chunks),
+          call_cleanup('$assert_data_chunks'(1, Chunks, Queue, Module),
+                       '$join_load_workers'(Ids, _))
+        ),
+        message_queue_destroy(Queue)).
+
+'$data_chunk'([From,To|_], I, I, From, To).
+'$data_chunk'([_|Offsets], I0, I, From, To) :-
+    Offsets = [_,_|_],
+    I1 is I0+1,
+    '$data_chunk'(Offsets, I1, I, From, To).
+
+'$data_chunk_worker'(Queue, I, File, From, To, ReadOptions) :-
+    catch(( '$read_data_chunk'(File, From, To, ReadOptions, Clauses),
+            Result = clauses(Clauses)
+          ), E, Result = exception(E)),
+    thread_send_message(Queue, chunk(I, Result)).
+
+'$assert_data_chunks'(I, Chunks, Queue, Module) :-
+    I =< Chunks,
+    !,
+    thread_get_message(Queue, chunk(I, Result)),
+    (   Result = clauses(Clauses)
+    ->  '$assert_data'(Clauses, Module)
+    ;   Result = exception(E),
+        throw(E)
+    ),
+    I2 is I+1,
+    '$assert_data_chunks'(I2, Chunks, Queue, Module).
+'$assert_data_chunks'(_, _, _, _).
+
+%!  '$read_data_chunk'(+File, +From, +To, +ReadOptions, -Clauses)
+%
+%   Read the clauses of File that start at or after byte offset From
+%   and before To.
+
+'$read_data_chunk'(File, From, To, ReadOptions, Clauses) :-
+    setup_call_cleanup(
+        open(File, read, In, [mmap(true)]),
+        ( seek(In, From, bof, _),
+          '$read_data_terms'(In, To, ReadOptions, Clauses)
+        ),
+        close(In)).
+
+'$read_data_terms'(In, To, ReadOptions, Clauses) :-
+    read_term(In, Term, [term_position(Pos)|ReadOptions]),
+    (   Term == end_of_file
+    ->  Clauses = []
+    ;   stream_position_data(byte_count, Pos, Start),
+        Start >= To
+    ->  Clauses = []
+    ;   Clauses = [Term|Rest],
+        '$read_data_terms'(In, To, ReadOptions, Rest)
+    ).
+
+'$assert_data'([], _).
+'$assert_data'([H|T], Module) :-
+    assertz(Module:H),
+    '$assert_data'(T, Module).
+
 
 '$load_one_file'(Spec, Module, Options) :-
     atomic(Spec),
@@ -1177,6 +1177,10 @@ trie_property(lookup_count(_)).                 % is enabled in pl-trie.h
 trie_property(gen_call_count(_)).
 trie_property(invalidated(_)).
 trie_property(reevaluated(_)).
+trie_property(answer_count(_)).
+trie_property(duplicate_count(_)).
+trie_property(suspension_count(_)).
+trie_property(completion_time(_)).
 
 
                 /********************************
@@ -42,6 +42,8 @@
             undefined/0,
 
             current_table/2,            % :Variant, ?Table
+            table_statistics/2,         % :Variant, ?Statistic
+            table_statistics/0,
             abolish_all_tables/0,
             abolish_table_subgoals/1,   % :Subgoal
             abolish_module_tables/1,    % +Module
@@ -67,6 +69,7 @@
     start_tabling(+, +, 0),
     start_tabling(+, +, 0, +, ?),
     current_table(:, -),
+    table_statistics(:, ?),
     abolish_table_subgoals(:),
     '$wfs_call'(0, :).
 
@@ -850,6 +853,107 @@ current_table(M:Variant, Trie) :-
     ;   trie_lookup(VariantTrie, M:Variant, Trie)
     ).
 
+%!  table_statistics(:Variant, ?Statistic) is nondet.
+%
+%   True when Statistic is a statistic   about  the answer table for
+%   Variant. Statistic is one of:
+%
+%     - answers(Count)
+%       Number of answers currently in the table.
+%     - answers_added(Count)
+%       Number of answers added while (re-)evaluating the table.
+%     - duplicate_answers(Count)
+%       Number of derived answers that were already in the table.
+%     - suspensions(Count)
+%       Number of suspensions (consumers) added to the worklist.
+%     - completion_time(Seconds)
+%       Wall time between creating the table and its completion,
+%       accumulated over re-evaluations.
+%     - size(Bytes)
+%       Memory used by the answer trie.
+%     - compiled_size(Bytes)
+%       Memory used by the compiled answer trie (if compiled).
+%     - gen_call_count(Count)
+%       Number of times the complete table was used to enumerate
+%       answers through a compiled trie.
+%     - invalidated(Count)
+%       Number of times an incremental table was invalidated.
+%     - reevaluated(Count)
+%       Number of times an incremental table was re-evaluated.
+%
+%   The counters  are only  maintained if  the system  is compiled
+%   with `O_TRIE_STATS`.
+
+table_statistics(Variant, Statistic) :-
+    current_table(Variant, Trie),
+    table_statistic(Statistic, Property),
+    '$trie_property'(Trie, Property).
+
+table_statistic(answers(C),           value_count(C)).
+table_statistic(answers_added(C),     answer_count(C)).
+table_statistic(duplicate_answers(C), duplicate_count(C)).
+table_statistic(suspensions(C),       suspension_count(C)).
+table_statistic(completion_time(T),   completion_time(T)).
+table_statistic(size(B),              size(B)).
+table_statistic(compiled_size(B),     compiled_size(B)).
+table_statistic(gen_call_count(C),    gen_call_count(C)).
+table_statistic(invalidated(C),       invalidated(C)).
+table_statistic(reevaluated(C),       reevaluated(C)).
+
+%!  table_statistics is det.
+%
+%   Print the table statistics aggregated per tabled predicate, most
+%   expensive (in memory) first.
+
+table_statistics :-
+    findall(PI-Stats, table_summary(PI, Stats), Pairs0),
+    msort(Pairs0, Pairs1),
+    sum_table_stats(Pairs1, Pairs),
+    findall(B-(PI-S), (member(PI-S, Pairs), arg(7, S, B)), Keyed),
+    sort(1, @>=, Keyed, SortedKeyed),
+    findall(Pair, member(_-Pair, SortedKeyed), Sorted),
+    format('~w~t~40|~t~w~8+~t~w~10+~t~w~10+~t~w~10+~t~w~10+~t~w~8+~t~w~12+~n',
+           [ 'Predicate', 'Tables', 'Answers', 'Dupl', 'Susp', 'Reeval',
+             'Time', 'Bytes' ]),
+    forall(member(PI-t(N,A,D,S,R,T,B), Sorted),
+           format('~q~t~40|~t~D~8+~t~D~10+~t~D~10+~t~D~10+~t~D~10+~t~3f~8+~t~D~12+~n',
+                  [PI, N, A, D, S, R, T, B])).
+
+table_summary(M:Name/Arity, t(1,A,D,S,R,T,B)) :-
+    current_table(M:Variant, Trie),
+    functor(Variant, Name, Arity),
+    table_property(Trie, value_count(A), 0),
+    table_property(Trie, duplicate_count(D), 0),
+    table_property(Trie, suspension_count(S), 0),
+    table_property(Trie, reevaluated(R), 0),
+    table_property(Trie, completion_time(T), 0.0),
+    table_property(Trie, size(B), 0).
+
+table_property(Trie, Property, Default) :-
+    (   '$trie_property'(Trie, Property)
+    ->  true
+    ;   arg(1, Property, Default)
+    ).
+
+sum_table_stats([], []).
+sum_table_stats([PI-S0|T0], [PI-S|T]) :-
+    sum_table_stats(T0, PI, S0, S, T1),
+    sum_table_stats(T1, T).
+
+sum_table_stats([PI-S1|T0], PI, S0, S, T) :-
+    !,
+    S0 =.. [t|L0],
+    S1 =.. [t|L1],
+    sum_list_pairs(L0, L1, L),
+    S2 =.. [t|L],
+    sum_table_stats(T0, PI, S2, S, T).
+sum_table_stats(T, _, S, S, T).
+
+sum_list_pairs([], [], []).
+sum_list_pairs([H0|T0], [H1|T1], [H|T]) :-
+    H is H0+H1,
+    sum_list_pairs(T0, T1, T).
+
 
                  /*******************************
                  *      WRAPPER GENERATION      *
@@ -15,6 +15,7 @@ check_include_file(ieeefp.h HAVE_IEEEFP_H)
 check_include_file(ieee754.h HAVE_IEEE754_H)
 check_include_file(libloaderapi.h HAVE_LIBLOADERAPI_H)
 check_include_file(limits.h HAVE_LIMITS_H)
+check_include_file(linux/io_uring.h HAVE_LINUX_IO_URING_H)
 check_include_file(locale.h HAVE_LOCALE_H)
 if(NOT CMAKE_SYSTEM_NAME STREQUAL "FreeBSD")
 check_include_file(malloc.h HAVE_MALLOC_H)
@@ -34,10 +35,12 @@ check_include_file(sys/ndir.h HAVE_SYS_NDIR_H)
 check_include_file(sys/param.h HAVE_SYS_PARAM_H)
 check_include_file(sys/resource.h HAVE_SYS_RESOURCE_H)
 check_include_file(sys/select.h HAVE_SYS_SELECT_H)
+check_include_file(sys/sendfile.h HAVE_SYS_SENDFILE_H)
 check_include_file(sys/stat.h HAVE_SYS_STAT_H)
 check_include_file(sys/syscall.h HAVE_SYS_SYSCALL_H)
 check_include_file(sys/termio.h HAVE_SYS_TERMIO_H)
 check_include_file(sys/termios.h HAVE_SYS_TERMIOS_H)
+check_include_file(sys/uio.h HAVE_SYS_UIO_H)
 check_include_file(sys/time.h HAVE_SYS_TIME_H)
 check_include_file(sys/types.h HAVE_SYS_TYPES_H)
 check_include_file(sys/wait.h HAVE_SYS_WAIT_H)
@@ -123,6 +126,11 @@ check_function_exists(access HAVE_ACCESS)
 check_function_exists(chmod HAVE_CHMOD)
 check_function_exists(fchmod HAVE_FCHMOD)
 check_function_exists(fcntl HAVE_FCNTL)
+check_function_exists(readv HAVE_READV)
+check_function_exists(writev HAVE_WRITEV)
+check_function_exists(copy_file_range HAVE_COPY_FILE_RANGE)
+check_function_exists(sendfile HAVE_SENDFILE)
+check_function_exists(splice HAVE_SPLICE)
 check_function_exists(fstat HAVE_FSTAT)
 check_function_exists(ftruncate HAVE_FTRUNCATE)
 check_function_exists(getcwd HAVE_GETCWD)
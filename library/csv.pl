@@ -42,6 +42,7 @@
             csv_read_stream/3,          % +Stream, -Data, +Options
 
             csv_read_file_row/3,        % +File, -Row, +Options
+            csv_read_file_forall/3,     % +File, :Goal, +Options
             csv_read_row/3,		% +Stream, -Row, +CompiledOptions
             csv_options/2,		% -Compiled, +Options
 
@@ -51,11 +52,14 @@
           ]).
 :- use_module(library(record)).
 :- use_module(library(error)).
-:- use_module(library(pure_input)).
 :- use_module(library(debug)).
 :- use_module(library(option)).
 :- use_module(library(apply)).
 :- use_module(library(dcg/basics)).
+:- use_module(library(thread)).
+
+:- meta_predicate
+    csv_read_file_forall(+, 1, +).
 
 /** <module> Process CSV (Comma-Separated Values) data
 
@@ -82,12 +86,17 @@ have the same name and arity.
                      ]).
 :- predicate_options(csv_read_file/3, 3,
                      [ pass_to(csv//2, 2),
-                       pass_to(phrase_from_file/3, 3)
+                       pass_to(open/4, 4)
                      ]).
 :- predicate_options(csv_read_file_row/3, 3,
                      [ pass_to(csv//2, 2),
                        pass_to(open/4, 4)
                      ]).
+:- predicate_options(csv_read_file_forall/3, 3,
+                     [ threads(positive_integer),
+                       pass_to(csv//2, 2),
+                       pass_to(open/4, 4)
+                     ]).
 :- predicate_options(csv_write_file/3, 3,
                      [ pass_to(csv//2, 2),
                        pass_to(open/4, 4)
@@ -114,9 +123,9 @@ have the same name and arity.
 %
 %   Read a CSV file into a list of   rows. Each row is a Prolog term
 %   with the same arity. Options  is   handed  to  csv//2. Remaining
-%   options  are  processed  by    phrase_from_file/3.  The  default
-%   separator depends on the file name   extension and is =|\t|= for
-%   =|.tsv|= files and =|,|= otherwise.
+%   options are processed by open/4.  The default separator depends
+%   on the file name extension and is =|\t|= for =|.tsv|= files and
+%   =|,|= otherwise.
 %
 %   Suppose we want to create a predicate   table/6  from a CSV file
 %   that we know contains 6 fields  per   record.  This  can be done
@@ -136,7 +145,10 @@ csv_read_file(File, Rows) :-
 csv_read_file(File, Rows, Options) :-
     default_separator(File, Options, Options1),
     make_csv_options(Options1, Record, RestOptions),
-    phrase_from_file(csv_roptions(Rows, Record), File, RestOptions).
+    setup_call_cleanup(
+        open(File, read, Stream, RestOptions),
+        csv_read_stream_rows(Stream, Rows, Record),
+        close(Stream)).
 
 
 default_separator(File, Options0, Options) :-
@@ -159,7 +171,60 @@ ext_separator(tsv, 0'\t).
 
 csv_read_stream(Stream, Rows, Options) :-
     make_csv_options(Options, Record, _),
-    phrase_from_stream(csv_roptions(Rows, Record), Stream).
+    csv_read_stream_rows(Stream, Rows, Record).
+
+%   csv_read_stream_rows(+Stream, -Rows, +Record)
+%
+%   Read all rows from Stream using '$csv_read_row'/4, which implements
+%   the same grammar as csv//2 in C.  The first six arguments of the
+%   csv_options record are accessed by position from C.
+
+csv_read_stream_rows(Stream, Rows, Record) :-
+    stream_skip_header(Stream, Record),
+    stream_rows(Stream, Rows, Record).
+
+stream_rows(Stream, Rows, Record) :-
+    '$csv_read_row'(Stream, Row, Record, false),
+    (   Row == end_of_file
+    ->  Rows = []
+    ;   functor(Row, _, Arity),
+        check_arity(Record, Arity),
+        debug(csv, 'Row: ~p', [Row]),
+        Rows = [Row|More],
+        stream_rows(Stream, More, Record)
+    ).
+
+stream_skip_header(Stream, Options) :-
+    csv_options_skip_header(Options, CommentStart),
+    nonvar(CommentStart),
+    !,
+    atom_length(CommentStart, Len),
+    stream_skip_header_lines(Stream, CommentStart, Len),
+    stream_skip_blank_lines(Stream).
+stream_skip_header(_, _).
+
+stream_skip_header_lines(Stream, CommentStart, Len) :-
+    peek_string(Stream, Len, Start),
+    atom_string(CommentStart, Start),
+    !,
+    read_string(Stream, "\n\r", "", Sep, _Comment),
+    (   Sep == 0'\r,
+        peek_char(Stream, '\n')
+    ->  get_char(Stream, _)
+    ;   true
+    ),
+    stream_skip_header_lines(Stream, CommentStart, Len).
+stream_skip_header_lines(_, _, _).
+
+stream_skip_blank_lines(Stream) :-
+    peek_char(Stream, C),
+    (   C == '\n'
+    ;   C == '\r'
+    ),
+    !,
+    get_char(Stream, _),
+    stream_skip_blank_lines(Stream).
+stream_skip_blank_lines(_).
 
 
 %!  csv(?Rows)// is det.
@@ -413,11 +478,6 @@ end_of_record --> eos.                  % unterminated last record
 %     Line is unified with the 1-based line-number from which Row is
 %     read.  Note that Line is not the physical line, but rather the
 %     _logical_ record number.
-%
-%   @tbd    Input is read line by line.  If a record separator is
-%           embedded in a quoted field, parsing the record fails and
-%           another line is added to the input.  This does not nicely
-%           deal with other reasons why parsing the row may fail.
 
 csv_read_file_row(File, Row, Options) :-
     default_separator(File, Options, Options1),
@@ -438,6 +498,99 @@ csv_read_stream_row(Stream, Row, Line, Options) :-
     ).
 
 
+%!  csv_read_file_forall(+File, :Goal, +Options) is semidet.
+%
+%   Call call(Goal, Row) for each row in File, similar to
+%   forall(csv_read_file_row(File, Row, Options), call(Goal, Row)).
+%   Fails if Goal fails for some row or File contains a syntax error.
+%   Rows are read from the stream one by one and are discarded after
+%   Goal completes, so memory usage does not depend on the size of
+%   File.  Besides the options of csv_read_file/3, this predicate
+%   processes:
+%
+%     * threads(+Count)
+%     If Count is larger than 1 (default 1), File is split into byte
+%     ranges that start at a record boundary.  These are parsed by
+%     Count threads using concurrent/3, calling Goal in the thread
+%     that parsed the row.  The order in which Goal is called is
+%     undefined.  The first row is processed before the others to
+%     determine the arity if match_arity is `true`.  Splitting
+%     requires an ASCII separator and an `octet`, `ascii`,
+%     `iso_latin_1` or `utf8` encoding; otherwise File is processed
+%     sequentially.
+%
+%   Using thread_send_message(Queue) as Goal passes the rows to a
+%   message queue for processing by other threads.  The example below
+%   asserts the rows of a large file using all cores.
+%
+%       ==
+%       ?- current_prolog_flag(cpu_count, N),
+%          csv_read_file_forall(File, assertz, [threads(N)]).
+%       ==
+
+csv_read_file_forall(File, Goal, Options) :-
+    default_separator(File, Options, Options1),
+    make_csv_options(Options1, Record, Options2),
+    select_option(threads(Threads), Options2, OpenOptions, 1),
+    must_be(positive_integer, Threads),
+    setup_call_cleanup(
+        open(File, read, Stream, OpenOptions),
+        ( stream_skip_header(Stream, Record),
+          (   Threads > 1,
+              csv_chunked_stream(Stream, Record)
+          ->  csv_forall_rows(Stream, 1, Goal, Record),
+              size_file(File, Size),
+              ChunkSize is max(65536, Size//(Threads*4)),
+              '$csv_chunks'(Stream, Record, ChunkSize, Chunks)
+          ;   csv_forall_rows(Stream, infinite, Goal, Record),
+              Chunks = []
+          )
+        ),
+        close(Stream)),
+    delete(OpenOptions, alias(_), ChunkOptions),
+    maplist(csv_chunk_goal(File, ChunkOptions, Goal, Record), Chunks, Goals),
+    concurrent(Threads, Goals, []).
+
+csv_chunked_stream(Stream, Record) :-
+    csv_options_separator(Record, Sep),
+    Sep < 128,
+    stream_property(Stream, encoding(Enc)),
+    memberchk(Enc, [octet, ascii, iso_latin_1, utf8]).
+
+csv_chunk_goal(File, OpenOptions, Goal, Record, chunk(Offset, Rows),
+               csv_forall_chunk(File, OpenOptions, Offset, Rows,
+                                Goal, Record)).
+
+csv_forall_chunk(File, OpenOptions, Offset, Rows, Goal, Record) :-
+    setup_call_cleanup(
+        open(File, read, Stream, OpenOptions),
+        ( seek(Stream, Offset, bof, _),
+          csv_forall_rows(Stream, Rows, Goal, Record)
+        ),
+        close(Stream)).
+
+%   csv_forall_rows(+Stream, +Count, :Goal, +Record)
+%
+%   Call Goal on the next Count rows of Stream or until the end of
+%   the input.  Count is `infinite` to process all rows.
+
+csv_forall_rows(_, 0, _, _) :-
+    !.
+csv_forall_rows(Stream, Count, Goal, Record) :-
+    '$csv_read_row'(Stream, Row, Record, false),
+    (   Row == end_of_file
+    ->  true
+    ;   functor(Row, _, Arity),
+        check_arity(Record, Arity),
+        \+ \+ call(Goal, Row),
+        (   Count == infinite
+        ->  Count1 = Count
+        ;   Count1 is Count - 1
+        ),
+        csv_forall_rows(Stream, Count1, Goal, Record)
+    ).
+
+
 %!  csv_read_row(+Stream, -Row, +CompiledOptions) is det.
 %
 %   Read the next CSV record from Stream  and unify the result with Row.
@@ -445,38 +598,15 @@ csv_read_stream_row(Stream, Row, Line, Options) :-
 %   csv_options/2. Row is unified with   `end_of_file` upon reaching the
 %   end of the input.
 
-csv_read_row(Stream, Row, _Record) :-
-    at_end_of_stream(Stream),
-    !,
-    Row = end_of_file.
 csv_read_row(Stream, Row, Record) :-
-    read_lines_to_codes(Stream, Codes, Record, even),
-    phrase(row(Row0, Record), Codes),
-    !,
+    '$csv_read_row'(Stream, Row0, Record, true),
+    (   Row0 == end_of_file
+    ->  true
+    ;   functor(Row0, _, Arity),
+        check_arity(Record, Arity)
+    ),
     Row = Row0.
 
-read_lines_to_codes(Stream, Codes, Options, QuoteQuantity) :-
-    read_line_to_codes(Stream, Codes0),
-    Codes0 \== end_of_file,
-    (   (   csv_options_ignore_quotes(Options, true)
-        ;   check_quotes(Codes0, QuoteQuantity, even)
-        )
-    ->  Codes = Codes0
-    ;   append(Codes0, [0'\n|Tail], Codes),
-        read_lines_to_codes(Stream, Tail, Options, odd)
-    ).
-
-check_quotes([], QuoteQuantity, QuoteQuantity) :-
-    !.
-check_quotes([0'"|T], odd, Result) :-
-    !,
-    check_quotes(T, even, Result).
-check_quotes([0'"|T], even, Result) :-
-    !,
-    check_quotes(T, odd, Result).
-check_quotes([_|T], QuoteQuantity, Result) :-
-    check_quotes(T, QuoteQuantity, Result).
-
 
 %!  csv_options(-Compiled, +Options) is det.
 %
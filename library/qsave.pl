@@ -90,6 +90,8 @@ save_option(foreign,     qsave_foreign_option,
             "Include foreign code in state").
 save_option(obfuscate,   boolean,
             "Obfuscate identifiers").
+save_option(compress,    boolean,
+            "Compress the compiled program").
 save_option(verbose,     boolean,
             "Be more verbose about the state creation").
 save_option(undefined,   oneof([ignore,error]),
@@ -506,7 +508,11 @@ lock_files(_) :-
 %   Save the program itself as virtual machine code to Zipper.
 
 save_program(RC, SaveClass, Options) :-
-    zipper_open_new_file_in_zip(RC, '$prolog/state.qlf', StateFd, []),
+    (   option(compress(false), Options)
+    ->  ZipOptions = [method(store)]
+    ;   ZipOptions = []
+    ),
+    zipper_open_new_file_in_zip(RC, '$prolog/state.qlf', StateFd, ZipOptions),
     setup_call_cleanup(
         ( current_prolog_flag(access_level, OldLevel),
           set_prolog_flag(access_level, system), % generate system modules
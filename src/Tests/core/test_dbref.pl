@@ -86,5 +86,21 @@ test(recorded_vt, [true([K1,K2] == [test_1,test_2]), nondet]) :-
 	recorded(K1, a1),
 	erase(R1),
 	erase(R2).
+test(ground_image, true(T2 == T)) :-
+	numlist(1, 100, L),
+	findall(p(I, "s", 1.5, 123456789012345678901234567890, f(x), [a]),
+		member(I, L), T),
+	recorda(test, T, Ref),
+	garbage_collect,
+	recorded(test, T1, Ref),
+	assertion(T1 == T),
+	instance(Ref, T2),
+	erase(Ref).
+test(ground_image_partial, true(T1 =@= T)) :-
+	numlist(1, 100, L),
+	T = f(X, L, X, _),
+	recorda(test, T, Ref),
+	recorded(test, T1, Ref),
+	erase(Ref).
 
 :- end_tests(recorded).
@@ -101,4 +101,94 @@ test(error, error(permission_error(fast_serialize, blob, S))) :-
 	    fast_write(S, a(X,X,S)),
 	    close(S)).
 
+test(dictionary) :-
+	findall(T, term(_,T), L),
+	fastrw_options(L, [dictionary(true)]).
+test(share) :-
+	findall(T, term(_,T), L),
+	fastrw_options(L, [share(true)]).
+test(share_size) :-
+	numlist(1, 100, L0),
+	numlist(1, 100, L1),
+	fast_write_size(f(L0,L1), [], Plain),
+	setup_call_cleanup(
+	    tmp_file_stream(binary, File, Out),
+	    fast_write(Out, f(L0,L1), [share(true)]),
+	    close(Out)),
+	size_file(File, Size),
+	setup_call_cleanup(
+	    open(File, read, In, [type(binary)]),
+	    fast_read(In, T),
+	    close(In)),
+	delete_file(File),
+	assertion(Size*3 < Plain*2),
+	assertion(T == f(L0,L1)),
+	T = f(A,B),
+	assertion(same_term(A,B)).
+test(dictionary_size) :-
+	numlist(1, 100, L),
+	maplist([I,point(x,y,I)]>>true, L, Points),
+	fast_write_size(Points, [], Plain),
+	fast_write_size(Points, [dictionary(true)], Dict),
+	assertion(Dict*3 < Plain*2).
+test(dictionary_error, error(permission_error(fast_serialize, blob, S))) :-
+	setup_call_cleanup(
+	    ( open_null_stream(S),
+	      set_stream(S, encoding(octet))
+	    ),
+	    fast_write(S, a(S), [dictionary(true)]),
+	    close(S)).
+test(dictionary_missing, error(syntax_error(fastrw_dictionary))) :-
+	setup_call_cleanup(
+	    tmp_file_stream(binary, File, Out),
+	    ( fast_write(Out, f(a), [dictionary(true)]),
+	      byte_count(Out, Skip),
+	      fast_write(Out, f(a), [dictionary(true)])
+	    ),
+	    close(Out)),
+	call_cleanup(
+	    setup_call_cleanup(
+		open(File, read, In, [type(binary)]),
+		( seek(In, Skip, bof, _),
+		  fast_read(In, _)
+		),
+		close(In)),
+	    delete_file(File)).
+
+%!	fastrw_options(+Terms, +Options)
+%
+%	Write each of Terms three times, mixing fast_write/3 using
+%	Options and fast_write/2 and verify we can read them back.
+
+fastrw_options(L, Options) :-
+	setup_call_cleanup(
+	    tmp_file_stream(binary, File, Out),
+	    forall(member(T, L),
+		   ( fast_write(Out, T, Options),
+		     fast_write(Out, T),
+		     fast_write(Out, T, Options)
+		   )),
+	    close(Out)),
+	setup_call_cleanup(
+	    open(File, read, In, [type(binary)]),
+	    ( maplist(read_and_check3(In), L),
+	      fast_read(In, EOF),
+	      assertion(EOF == end_of_file)
+	    ),
+	    close(In)),
+	delete_file(File).
+
+fast_write_size(Term, Options, Size) :-
+	setup_call_cleanup(
+	    tmp_file_stream(binary, File, Out),
+	    fast_write(Out, Term, Options),
+	    close(Out)),
+	size_file(File, Size),
+	delete_file(File).
+
+read_and_check3(In, T) :-
+	read_and_check(In, T),
+	read_and_check(In, T),
+	read_and_check(In, T).
+
 :- end_tests(fastrw).
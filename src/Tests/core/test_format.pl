@@ -60,5 +60,36 @@ test(atom, A == 'a\n') :-
 	format(atom(A), 'a\n', []).
 test(atom, A == '--++') :-
 	format(atom(A), '~`-t~`+t~4+', []).
+test(cached, L == ['x:1  |', 'y:22 |', 'z:333|']) :-
+	findall(A, ( member(K-V, [x-1,y-22,z-333]),
+		     format(atom(A), '~w:~w~t~5||', [K,V])
+		   ), L).
+test(cached, A == 'v=<1>') :-
+	catch(format(atom(_), 'v=~Y', [1]),
+	      error(existence_error(format_character, 'Y'), _),
+	      true),
+	format_predicate('Y', fmt_y(_,_)),
+	format(atom(A), 'v=~Y', [1]).
+test(cached, A == '\u00e9t\u00e9 42') :-
+	format(atom(A), '\u00e9t\u00e9 ~d', [42]).
+
+test(cached, L == [a1,a2,a3]) :-
+	forall(between(1, 2000, I),
+	       ( atom_concat(evict_, I, F),
+		 format(atom(_), F, []) )),
+	findall(A, ( between(1, 3, I),
+		     format(atom(A), 'a~d', [I])
+		   ), L).
+test(cached, A == '<ok>') :-
+	format(atom(A), '<~@>', [fmt_many(2000)]).
+
+fmt_many(N) :-
+	forall(between(1, N, I),
+	       ( atom_concat(nested_, I, F),
+		 format(atom(_), F, []) )),
+	format('ok').
+
+fmt_y(_, X) :-
+	format('<~w>', [X]).
 
 :- end_tests(format).
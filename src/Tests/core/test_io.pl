@@ -97,6 +97,157 @@ test(reuse_alias, error(permission_error(open, source_sink, alias(a)))) :-
 	    ),
 	    open(nonexisting, read, _In, [alias(a)]),
 	    close(S)).
+test(adaptive_buffer, [Size0-Size1 == 4096-4096, cleanup(delete_file(Tmp))]) :-
+	tmp_file_stream(octet, Tmp, Out0), close(Out0),
+	numlist(1, 20000, L),
+	setup_call_cleanup(
+	    open(Tmp, write, Out, [type(binary)]),
+	    ( set_stream(Out, adaptive_buffer(false)),
+	      fast_write(Out, L),
+	      stream_property(Out, buffer_size(Size0))
+	    ),
+	    close(Out)),
+	setup_call_cleanup(
+	    open(Tmp, read, In, [type(binary)]),
+	    ( set_stream(In, adaptive_buffer(false)),
+	      fast_read(In, L2),
+	      stream_property(In, buffer_size(Size1))
+	    ),
+	    close(In)),
+	assertion(L2 == L).
+test(adaptive_grow, [Size > 4096, cleanup(delete_file(Tmp))]) :-
+	tmp_file_stream(text, Tmp, Out),
+	forall(between(1, 20000, I), format(Out, '~d~n', [I])),
+	close(Out),
+	setup_call_cleanup(
+	    open(Tmp, read, In),
+	    ( read_string(In, _, S),
+	      stream_property(In, buffer_size(Size))
+	    ),
+	    close(In)),
+	split_string(S, "\n", "", Lines),
+	assertion(length(Lines, 20001)).
+test(async, [Lines-Tail == 20001-"000\nok", cleanup(delete_file(Tmp))]) :-
+	tmp_file_stream(text, Tmp, Out0), close(Out0),
+	setup_call_cleanup(
+	    open(Tmp, write, Out, [async(true)]),
+	    ( assert_async(Out),
+	      forall(between(1, 20000, I), format(Out, '~d~n', [I]))
+	    ),
+	    close(Out)),
+	setup_call_cleanup(
+	    open(Tmp, append, App, [async(true)]),
+	    write(App, ok),
+	    close(App)),
+	setup_call_cleanup(
+	    open(Tmp, read, In, [async(true)]),
+	    ( assert_async(In),
+	      read_string(In, _, S),
+	      seek(In, -6, eof, _),
+	      read_string(In, _, Tail)
+	    ),
+	    close(In)),
+	split_string(S, "\n", "", L),
+	length(L, Lines).
+test(mmap, [T1-T2-T3 == f(1)-f(2)-f(1), cleanup(delete_file(Tmp))]) :-
+	tmp_file_stream(text, Tmp, Out),
+	forall(between(1, 10000, I), format(Out, 'f(~d).~n', [I])),
+	close(Out),
+	setup_call_cleanup(
+	    open(Tmp, read, In, [mmap(true)]),
+	    ( (   current_prolog_flag(unix, true)
+	      ->  assertion(stream_property(In, mmap(true)))
+	      ;   true
+	      ),
+	      assertion(stream_property(In, file_no(_))),
+	      assertion(stream_property(In, reposition(true))),
+	      read(In, T1),
+	      set_stream(In, buffer_size(100)),
+	      read(In, T2),
+	      seek(In, 0, bof, _),
+	      read(In, T3),
+	      read_string(In, _, S)
+	    ),
+	    close(In)),
+	sub_string(S, _, 9, 0, Last),
+	assertion(Last == "(10000).\n").
+test(copy_stream_data, [Size-Pos == 100000-pos(3,2,10),
+			cleanup(maplist(delete_file, [Tmp1,Tmp2]))]) :-
+	tmp_file_stream(octet, Tmp1, Out1),
+	forall(between(1, 100000, I), (B is I mod 256, put_byte(Out1, B))),
+	close(Out1),
+	tmp_file_stream(octet, Tmp2, Out2),
+	setup_call_cleanup(
+	    open(Tmp1, read, In, [type(binary)]),
+	    ( copy_stream_data(In, Out2, 10),
+	      copy_stream_data(In, Out2)
+	    ),
+	    close(Out2)),
+	close(In),
+	size_file(Tmp2, Size),
+	assertion(read_file_to_codes(Tmp1, Bytes, [type(binary)])),
+	assertion(read_file_to_codes(Tmp2, Bytes, [type(binary)])),
+	setup_call_cleanup(
+	    open(Tmp1, write, Out3, [encoding(utf8)]),
+	    format(Out3, '\u00e9t\u00e9~nabc~nde', []),
+	    close(Out3)),
+	setup_call_cleanup(
+	    ( open(Tmp1, read, In3, [encoding(utf8)]),
+	      open(Tmp2, write, Out4, [encoding(utf8)])
+	    ),
+	    ( copy_stream_data(In3, Out4),
+	      line_count(Out4, LC),
+	      line_position(Out4, LP),
+	      character_count(Out4, CC),
+	      Pos = pos(LC,LP,CC)
+	    ),
+	    ( close(In3),
+	      close(Out4)
+	    )).
+test(read_string, Lines-S7-Pos ==
+		  ["ab c", "\u00e9t\u00e9 \u20ac", "", "x\ty"]-"ab c\n\u00e9t"-
+		  pos(4,9,16)) :-
+	open_string("ab c\n\u00e9t\u00e9 \u20ac\r\n\nx\ty", In0),
+	read_string(In0, 7, S7),
+	close(In0),
+	setup_call_cleanup(
+	    tmp_file_stream(utf8, Tmp, Out),
+	    ( format(Out, 'ab c~n\u00e9t\u00e9 \u20ac\r~n~nx\ty', []),
+	      close(Out),
+	      setup_call_cleanup(
+		  open(Tmp, read, In, [encoding(utf8)]),
+		  ( read_lines(In, Lines),
+		    line_count(In, LC),
+		    line_position(In, LP),
+		    character_count(In, CC),
+		    Pos = pos(LC,LP,CC)
+		  ),
+		  close(In))
+	    ),
+	    delete_file(Tmp)).
+
+%!	assert_async(+Stream)
+%
+%	Assert that Stream, opened using async(true), uses the io_uring
+%	backend on Linux and is associated with the file descriptor of a
+%	regular file, which implies reposition(true).
+
+assert_async(Stream) :-
+	(   current_prolog_flag(arch, Arch),
+	    sub_atom(Arch, _, _, 0, linux)
+	->  assertion(stream_property(Stream, async(true)))
+	;   true
+	),
+	assertion(stream_property(Stream, file_no(_))),
+	assertion(stream_property(Stream, reposition(true))).
+
+read_lines(In, Lines) :-
+	read_string(In, "\n", "\r", Sep, Line),
+	(   Sep == -1
+	->  Lines = [Line]
+	;   Lines = [Line|T],
+	    read_lines(In, T)
+	).
 
 :- end_tests(io).
 
@@ -67,6 +67,43 @@ test(position,
                 [ subterm_positions(TermPos),
                   comments(Comments)
                 ]).
+test(ascii_runs, Terms == [f(Id, Q, 'a\nb\\c', "s\u00e9"), g(12345)]) :-
+	length(Cs, 5000), maplist(=(0'x), Cs), atom_codes(Id, Cs),
+	length(Qs, 5000), maplist(=(0'Q), Qs), atom_codes(Q, Qs),
+	format(string(L1), 'f(~w, ~q, \'a\\nb\\\\c\', "s\\u00e9").~n',
+	       [Id, Q]),
+	string_length(L1, Start),
+	tmp_file_stream(text, File, Out),
+	format(Out, '~sg(12345).~n', [L1]),
+	close(Out),
+	setup_call_cleanup(
+	    open(File, read, In),
+	    ( read_term(In, T1, []),
+	      read_term(In, T2, [term_position(Pos)]),
+	      Terms = [T1,T2],
+	      stream_position_data(line_count, Pos, Line),
+	      stream_position_data(char_count, Pos, Char),
+	      assertion(Line == 2),
+	      assertion(Char == Start)
+	    ),
+	    close(In)),
+	delete_file(File).
+
+test(data_only, T == f(a, -1, "s", [x,y|Z], {b}, 'q q', g(1.5))) :-
+	term_string(T,
+		    "f(a, -1, \"s\", [x,y|Z], {b}, 'q q', g(1.5))",
+		    [data_only(true), variable_names(['Z'=Z])]).
+test(data_only, error(syntax_error(operator_expected))) :-
+	term_string(_, "f(a-b)", [data_only(true)]).
+test(data_only, error(syntax_error(operator_expected))) :-
+	term_string(_, "a :- b", [data_only(true)]).
+test(data_only, error(syntax_error(operator_expected))) :-
+	term_string(_, "{a,b}", [data_only(true)]).
+test(data_only, T =@= T0) :-
+	T0 = f((a,b), {c,d}, a:b, - 1, [x|_]),
+	with_output_to(string(S),
+		       write_term(T0, [quoted(true), ignore_ops(true)])),
+	term_string(T, S, [data_only(true)]).
 
 :- end_tests(read_term).
 
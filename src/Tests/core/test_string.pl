@@ -78,6 +78,15 @@ test(split_string, L == ["SWI-Prolog"]) :-
 	split_string("  SWI-Prolog  ", "", "\s\t\n", L).
 test(split_string, L == [""]) :-
 	split_string(" ", "", " ", L).
+test(split_string, L == ["a", "bb", "", "c\u20ac", "d"]) :-
+	split_string("  a   bb ,, c\u20ac , d ", ",\s", " ", L0),
+	exclude(==(""), L0, L1),
+	split_string("a,bb,,c\u20ac,d", ",", "", L),
+	assertion(L1 == ["a", "bb", "c\u20ac", "d"]).
+test(split_string, L == ["x", "y\u00e9", "z"]) :-
+	split_string("x\u20acy\u00e9\u20acz", "\u20ac", "", L).
+test(sub_string, L == [2-18, 17-3]) :-
+	findall(B-A, sub_string("abab\u20accdefghijklmnab\u20acxyz", B, 3, A, "ab\u20ac"), L).
 test(string_lower, L == "abc") :-
 	string_lower("aBc", L).
 test(string_upper, L == "ABC") :-
@@ -244,5 +244,8 @@ test(error, error(instantiation_error)) :-
 	atomic_list_concat([1,_], _).
 test(error, error(domain_error(non_empty_atom, ''))) :-
 	atomic_list_concat(_L, '', text).
+test(split, L == ['', 'a', 'bc', 'def ghijklmnopqrstuvwxyz', '']) :-
+	atomic_list_concat(L, ' - ',
+			   ' - a - bc - def ghijklmnopqrstuvwxyz - ').
 
 :- end_tests(atomic_list_concat).
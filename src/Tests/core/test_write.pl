@@ -94,6 +94,19 @@ test(varname, L == [39,1040,1080,39]) :-
 	with_output_to(atom(X),
 		       writeq(A)),
 	atom_codes(X,L).
+test(quoted_runs, X-Pos == '[\'it\\\'s a\\nb\',"d\\"q\\\\\u00e9"]'-24) :-
+	with_output_to(atom(X),
+		       ( write_canonical(['it\'s a\nb', "d\"q\\\u00e9"]),
+			 line_position(current_output, Pos)
+		       )).
+
+test(quote_cache, Texts == ['\'Abc\'', 'Abc']) :-
+	with_output_to(atom(T1), writeq('Abc')),
+	setup_call_cleanup(
+	    set_prolog_flag(var_prefix, true),
+	    with_output_to(atom(T2), writeq('Abc')),
+	    set_prolog_flag(var_prefix, false)),
+	Texts = [T1, T2].
 
 :- end_tests(write_canonical).
 
@@ -138,6 +151,28 @@ test(nan) :-
 	atom_number(F, Float),
 	abs(Float) >= 1,
 	abs(Float) < 2.
+test(shortest, L == [ '0.1', '0.30000000000000004', '0.3333333333333333',
+		      '123.456', '-0.0', '1.0e+23', '9.007199254740994e+15',
+		      '5.0e-324', '2.2250738585072014e-308',
+		      '1.7976931348623157e+308'
+		    ]) :-
+	X is 0.1+0.2,
+	Y is 1/3,
+	Z is -0.0,
+	W is 2.0**53+2,
+	M is 2.0**(-1074),
+	maplist(term_to_atom,
+		[0.1, X, Y, 123.456, Z, 1.0e23, W, M, 2.2250738585072014e-308,
+		 1.7976931348623157e308], L).
+test(round_trip) :-
+	forall(( between(-1074, 1023, E),
+		 member(D, [0, 1]),
+		 F is 2.0**E + D*2.0**max(E-52, -1074)
+	       ),
+	       ( term_to_atom(F, A),
+		 term_to_atom(F2, A),
+		 assertion(F2 =:= F)
+	       )).
 
 :- end_tests(write_float).
 
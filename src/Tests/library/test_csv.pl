@@ -35,7 +35,9 @@
 :- use_module(library(plunit)).
 
 test_csv :-
-	run_tests([ csv_read_file_row ]).
+	run_tests([ csv_read_file_row,
+		    csv_read_file
+		  ]).
 
 :- begin_tests(csv_read_file_row, []).
 :- use_module(library(csv)).
@@ -116,4 +118,64 @@ test(quoted_crlf_ignored) :-
            row('c2_2"',c3)
          ].
 
-:- end_tests(csv_read_file_row).
\ No newline at end of file
+:- end_tests(csv_read_file_row).
+
+:- begin_tests(csv_read_file, []).
+:- use_module(library(csv)).
+
+queue_rows(Q, Rows) :-
+  (   thread_get_message(Q, Row, [timeout(0)])
+  ->  Rows = [Row|T],
+      queue_rows(Q, T)
+  ;   Rows = []
+  ).
+
+test(quoted_crlf, Rows-Row == [row(a,'b\r\nc'),row(d,e)]-row(a,'b\nc')) :-
+  String = "a,\"b\r\nc\"\r\nd,e\r\n",
+  open_string(String, In1),
+  csv_read_stream(In1, Rows, []),
+  open_string(String, In2),
+  csv_options(Options, []),
+  csv_read_row(In2, Row, Options).
+
+test(options, Rows == [ r('a b','x y',1),
+                        r('caf\u00e9','"q',-2.5),
+                        r('',hello,'1 x')
+                      ]) :-
+  setup_call_cleanup(
+      tmp_file_stream(utf8, Tmp, Out),
+      ( format(Out, '# header~n#~n~n', []),
+        format(Out, ' A b ;"X Y"; 1~n', []),
+        format(Out, 'CAF\u00e9;"""Q"; -2.5\r~n', []),
+        format(Out, ';Hello;1 X', []),
+        close(Out),
+        csv_read_file(Tmp, Rows,
+                      [ separator(0';), strip(true), case(down),
+                        functor(r), skip_header(#), encoding(utf8)
+                      ])
+      ),
+      delete_file(Tmp)).
+
+test(forall, [ condition(current_prolog_flag(threads, true)),
+               Rows-Sorted == 20000-Rows1
+             ]) :-
+  setup_call_cleanup(
+      tmp_file_stream(text, Tmp, Out),
+      ( forall(between(1, 20000, I),
+               format(Out, '~d,"line~d\nx",~a~n', [I, I, "a\"\"b"])),
+        close(Out),
+        csv_read_file(Tmp, Rows1, []),
+        length(Rows1, Rows),
+        message_queue_create(Q),
+        csv_read_file_forall(Tmp, thread_send_message(Q), [threads(2)]),
+        queue_rows(Q, Rows2),
+        message_queue_destroy(Q),
+        msort(Rows2, Sorted)
+      ),
+      delete_file(Tmp)).
+
+test(syntax, fail) :-
+  open_string("a,\"b\"c\n", In),
+  csv_read_stream(In, _Rows, []).
+
+:- end_tests(csv_read_file).
@@ -79,7 +79,9 @@ test_tabling :-
                 bas,
                 push_ret,
 
-                answer_subsumption
+                answer_subsumption,
+                compile_threshold,
+                table_statistics
 	      ]).
 
 		 /*******************************
@@ -1368,6 +1370,72 @@ test(max, Max == 206) :-
 :- end_tests(answer_subsumption).
 
 
+:- begin_tests(compile_threshold,
+		[ setup(current_prolog_flag(table_compile_threshold, Old)),
+		  cleanup(( set_prolog_flag(table_compile_threshold, Old),
+			    abolish_all_tables ))
+		]).
+
+:- table ct/1.
+ct(X) :- between(1, 5, X).
+
+ct_compiled(Compiled) :-
+    current_table(ct(_), Trie),
+    (   '$trie_property'(Trie, compiled_size(_))
+    ->  Compiled = true
+    ;   Compiled = false
+    ).
+
+test(lazy, Compiled == [false,false,true]) :-
+    set_prolog_flag(table_compile_threshold, 2),
+    abolish_all_tables,
+    findall(C, ( between(1, 3, _),
+		 findall(X, ct(X), Xs),
+		 msort(Xs, [1,2,3,4,5]),
+		 ct_compiled(C)
+	       ), Compiled).
+test(eager, Compiled == true) :-
+    set_prolog_flag(table_compile_threshold, 0),
+    abolish_all_tables,
+    findall(X, ct(X), Xs),
+    msort(Xs, [1,2,3,4,5]),
+    ct_compiled(Compiled).
+
+:- end_tests(compile_threshold).
+
+
+:- begin_tests(table_statistics, [cleanup(abolish_all_tables)]).
+
+:- table ts_path/2.
+ts_path(X, Y) :- ts_path(X, Z), ts_edge(Z, Y).
+ts_path(X, Y) :- ts_edge(X, Y).
+
+ts_edge(1, 2).
+ts_edge(2, 3).
+ts_edge(3, 1).
+
+test(counters, [Answers,Added,Dupl] == [3,3,true]) :-
+    abolish_all_tables,
+    findall(Y, ts_path(1, Y), _),
+    table_statistics(ts_path(1,_), answers(Answers)),
+    table_statistics(ts_path(1,_), answers_added(Added)),
+    table_statistics(ts_path(1,_), duplicate_answers(D)),
+    (D > 0 -> Dupl = true ; Dupl = false).
+test(report, [Tables,Answers] == ["1","3"]) :-
+    abolish_all_tables,
+    findall(Y, ts_path(1, Y), _),
+    with_output_to(string(Output), table_statistics),
+    split_string(Output, "\n", "", Lines),
+    member(Line, Lines),
+    split_string(Line, " ", " ", Fields),
+    exclude(==(""), Fields, [PI,Tables,Answers|_]),
+    sub_string(PI, _, _, 0, ":ts_path/2"),
+    !.
+
+:- end_tests(table_statistics).
+
+
+
 		 /*******************************
 		 *	      COMMON		*
 		 *******************************/
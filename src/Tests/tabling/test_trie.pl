@@ -136,12 +136,87 @@ test(var2, set(Y == [1,2])) :-
         test_var(a, Y).
 test(var3, set(Y == [1])) :-
         test_var(c, Y).
+test(fanout, true) :-
+	forall(member(N, [2,4,5,16,17,100]),
+	       test_fanout(N)).
+test(fanout_delete, Keys == [2,4,6,8,10]) :-
+	trie_new(T),
+	forall(between(1, 10, I), trie_insert(T, f(I))),
+	forall(between(1, 10, I), (I mod 2 =:= 1 -> trie_delete(T, f(I), _) ; true)),
+	findall(I, trie_gen(T, f(I)), Keys0),
+	msort(Keys0, Keys).
+test(delete_in_gen, Keys == [1,3,5,7,9]) :-
+	trie_new(T),
+	forall(between(1, 10, I), trie_insert(T, f(I), I)),
+	findall(I, ( trie_gen(T, f(I)),
+		     J is I+1,
+		     ignore(trie_delete(T, f(J), _))
+		   ), Keys0),
+	msort(Keys0, Keys).
+test(reclaim_after_gen, Blocked-Reclaimed == 102-true) :-
+	trie_new(G),
+	trie_insert(G, a),
+	trie_insert(G, b),
+	trie_new(T),
+	forall(between(1, 100, I), trie_insert(T, f(I))),
+	findall(N, delete_in_open_gen(G, T, N), [Blocked|_]),
+	forall(between(1, 100, I), trie_insert(T, g(I))),
+	forall(between(1, 100, I), trie_delete(T, g(I), _)),
+	trie_property(T, node_count(After)),
+	(   After < Blocked
+	->  Reclaimed = true
+	;   Reclaimed = After
+	).
+test(gen_compiled_value, Pairs-Keys == [a-f(x),b-1]-[a,b]) :-
+	trie_new(T),
+	trie_insert(T, a, f(x)),
+	trie_insert(T, b, 1),
+	findall(K-V, trie_gen_compiled(T, K, V), Pairs0),
+	findall(K, trie_gen_compiled(T, K), Keys0),
+	msort(Pairs0, Pairs),
+	msort(Keys0, Keys).
+test(fanout_var, set(Y == [0,3])) :-
+	trie_new(T),
+	trie_insert(T, f(_, 0)),
+	forall(between(1, 10, I), trie_insert(T, f(I, I))),
+	trie_gen(T, f(3, Y)).
+test(gen_compiled_snapshot, Keys == [1,2,3,4,5]) :-
+	trie_new(T),
+	forall(between(1, 5, I), trie_insert(T, f(I))),
+	findall(I, ( trie_gen_compiled(T, f(I)),
+		     J is I+5,
+		     trie_insert(T, f(J))
+		   ), Keys0),
+	msort(Keys0, Keys).
+
+%!	delete_in_open_gen(+G, +T, -NodeCount)
+%
+%	Delete the keys f(1..100) from T while a trie_gen/2 choicepoint
+%	on G is open.  This blocks reclamation of the pruned nodes of T.
+
+delete_in_open_gen(G, T, N) :-
+	trie_gen(G, _),
+	forall(between(1, 100, I), trie_delete(T, f(I), _)),
+	trie_property(T, node_count(N)).
 
 shared_list(N, t(List,N)) :-
 	length(List, N),
 	reverse(List, R),
 	R = List.
 
+test_fanout(N) :-
+	trie_new(T),
+	forall(between(1, N, I), trie_insert(T, f(I, g(I)), I)),
+	forall(between(1, N, I), trie_lookup(T, f(I, g(I)), I)),
+	\+ trie_lookup(T, f(0, g(0)), _),
+	findall(I, trie_gen(T, f(I, _)), Is0),
+	msort(Is0, Is),
+	numlist(1, N, Is),
+	findall(I, trie_gen_compiled(T, f(I, _)), Cs0),
+	msort(Cs0, Is),
+	trie_gen(T, f(N, X)),
+	X == g(N).
+
 test_var(X, Y) :-
 	trie_new(T),
 	trie_insert(T, f(_, 1)),
@@ -51,7 +51,8 @@ test_threads :-
 		    thread_property,
 		    mutex,
 		    mutex_property,
-		    message_queue
+		    message_queue,
+		    load_files
 		  ]).
 
 
@@ -264,3 +265,58 @@ test(size_prop, true) :-
 	message_queue_destroy(Queue).
 
 :- end_tests(message_queue).
+
+
+		 /*******************************
+		 *	    LOAD_FILES		*
+		 *******************************/
+
+:- begin_tests(load_files, [cleanup(delete_load_files)]).
+
+:- dynamic
+	load_file/1.
+:- multifile
+	user:prolog_load_file/2.
+
+user:prolog_load_file(_:stop_load, _) :-
+	throw(stop_load).
+
+load_file_set(Files) :-
+	findall(File,
+		( between(1, 5, I),
+		  tmp_file_stream(text, File, Out),
+		  format(Out, ':- module(test_threads_load_~d, []).~n', [I]),
+		  forall(between(1, 100, J), format(Out, 'f(~d).~n', [J])),
+		  close(Out),
+		  assertz(load_file(File))
+		), Files).
+
+delete_load_files :-
+	forall(retract(load_file(File)),
+	       ( unload_file(File),
+		 delete_file(File)
+	       )).
+
+test(threads, Counts == [100,100,100,100,100]) :-
+	load_file_set(Files),
+	load_files(Files, [threads(3), silent(true)]),
+	findall(Count,
+		( between(1, 5, I),
+		  format(atom(M), 'test_threads_load_~d', [I]),
+		  aggregate_all(count, M:f(_), Count)
+		), Counts).
+test(threads_exception, throws(stop_load)) :-
+	load_files([stop_load, stop_load], [threads(2), silent(true)]).
+test(threads_type, error(type_error(integer, a))) :-
+	load_files([a,b], [threads(a)]).
+
+test(data_file, Is == Expected) :-
+	tmp_file_stream(text, File, Out),
+	forall(between(1, 1000, I),
+	       format(Out, 'd(~d, ~q, "~w. x").~n', [I, 'a. b', I])),
+	close(Out),
+	call_cleanup(load_data_file(test_threads_data:File, [threads(4)]),
+		     delete_file(File)),
+	findall(I, test_threads_data:d(I, 'a. b', _), Is),
+	numlist(1, 1000, Expected).
+:- end_tests(load_files).
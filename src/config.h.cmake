@@ -24,6 +24,7 @@
 #cmakedefine HAVE_CHMOD @HAVE_CHMOD@
 #cmakedefine HAVE_CLOCK_GETTIME @HAVE_CLOCK_GETTIME@
 #cmakedefine HAVE_CONFSTR @HAVE_CONFSTR@
+#cmakedefine HAVE_COPY_FILE_RANGE @HAVE_COPY_FILE_RANGE@
 #cmakedefine HAVE_CRTDBG_H @HAVE_CRTDBG_H@
 #cmakedefine HAVE_CTIME_R @HAVE_CTIME_R@
 #cmakedefine HAVE_CURSES_H @HAVE_CURSES_H@
@@ -86,6 +87,7 @@
 #cmakedefine HAVE_LIBUNWIND @HAVE_LIBUNWIND@
 #cmakedefine HAVE_LIBWINMM @HAVE_LIBWINMM@
 #cmakedefine HAVE_LIBWSOCK32 @HAVE_LIBWSOCK32@
+#cmakedefine HAVE_LINUX_IO_URING_H @HAVE_LINUX_IO_URING_H@
 #cmakedefine HAVE_LOCALECONV @HAVE_LOCALECONV@
 #cmakedefine HAVE_LOCALE_H @HAVE_LOCALE_H@
 #cmakedefine HAVE_LOCALTIME_R @HAVE_LOCALTIME_R@
@@ -132,6 +134,7 @@
 #cmakedefine HAVE_QSORT_S @HAVE_QSORT_S@
 #cmakedefine HAVE_RANDOM @HAVE_RANDOM@
 #cmakedefine HAVE_READLINK @HAVE_READLINK@
+#cmakedefine HAVE_READV @HAVE_READV@
 #cmakedefine HAVE_REMOVE @HAVE_REMOVE@
 #cmakedefine HAVE_RENAME @HAVE_RENAME@
 #cmakedefine HAVE_RINT @HAVE_RINT@
@@ -141,6 +144,7 @@
 #cmakedefine HAVE_SELECT @HAVE_SELECT@
 #cmakedefine HAVE_SEMA_INIT @HAVE_SEMA_INIT@
 #cmakedefine HAVE_SEM_INIT @HAVE_SEM_INIT@
+#cmakedefine HAVE_SENDFILE @HAVE_SENDFILE@
 #cmakedefine HAVE_SETENV @HAVE_SETENV@
 #cmakedefine HAVE_SETLOCALE @HAVE_SETLOCALE@
 #cmakedefine HAVE_SGTTYB @HAVE_SGTTYB@
@@ -157,6 +161,7 @@
 #cmakedefine HAVE_SIGSET @HAVE_SIGSET@
 #cmakedefine HAVE_SIGSETMASK @HAVE_SIGSETMASK@
 #cmakedefine HAVE_SLEEP @HAVE_SLEEP@
+#cmakedefine HAVE_SPLICE @HAVE_SPLICE@
 #cmakedefine HAVE_SRAND @HAVE_SRAND@
 #cmakedefine HAVE_SRANDOM @HAVE_SRANDOM@
 #cmakedefine HAVE_STAT @HAVE_STAT@
@@ -182,6 +187,7 @@
 #cmakedefine HAVE_SYS_PARAM_H @HAVE_SYS_PARAM_H@
 #cmakedefine HAVE_SYS_RESOURCE_H @HAVE_SYS_RESOURCE_H@
 #cmakedefine HAVE_SYS_SELECT_H @HAVE_SYS_SELECT_H@
+#cmakedefine HAVE_SYS_SENDFILE_H @HAVE_SYS_SENDFILE_H@
 #cmakedefine HAVE_SYS_STAT_H @HAVE_SYS_STAT_H@
 #cmakedefine HAVE_SYS_STROPTS_H @HAVE_SYS_STROPTS_H@
 #cmakedefine HAVE_SYS_SYSCALL_H @HAVE_SYS_SYSCALL_H@
@@ -189,6 +195,7 @@
 #cmakedefine HAVE_SYS_TERMIO_H @HAVE_SYS_TERMIO_H@
 #cmakedefine HAVE_SYS_TIME_H @HAVE_SYS_TIME_H@
 #cmakedefine HAVE_SYS_TYPES_H @HAVE_SYS_TYPES_H@
+#cmakedefine HAVE_SYS_UIO_H @HAVE_SYS_UIO_H@
 #cmakedefine HAVE_SYS_WAIT_H @HAVE_SYS_WAIT_H@
 #cmakedefine HAVE_TCSETATTR @HAVE_TCSETATTR@
 #cmakedefine HAVE_TERM_H @HAVE_TERM_H@
@@ -209,6 +216,7 @@
 #cmakedefine HAVE_WINSOCK2_H @HAVE_WINSOCK2_H@
 #cmakedefine HAVE_WORKING_FORK @HAVE_WORKING_FORK@
 #cmakedefine HAVE_WORKING_VFORK @HAVE_WORKING_VFORK@
+#cmakedefine HAVE_WRITEV @HAVE_WRITEV@
 #cmakedefine HAVE_WSAPOLL @HAVE_WSAPOLL@
 #cmakedefine HAVE_ZLIB_H @HAVE_ZLIB_H@
 #cmakedefine HAVE_ZUTIL_H @HAVE_ZUTIL_H@
@@ -135,6 +135,7 @@ stuff.
 #define EPLEXCEPTION	1001		/* errno: pending Prolog exception */
 
 #define SIO_BUFSIZE	(4096)		/* buffering buffer-size */
+#define SIO_MAXBUFSIZE	(256*1024)	/* max size for SIO_ADAPTIVE */
 #define SIO_LINESIZE	(1024)		/* Sgets() default buffer size */
 #define SIO_OMAGIC	(7212676)	/* old magic number */
 #define SIO_MAGIC	(7212677)	/* magic number */
@@ -258,6 +259,7 @@ typedef struct io_stream
 #define SIO_NOMUTEX	SmakeFlag(25)	/* Do not allow multi-thread access */
 #define SIO_ADVLOCK	SmakeFlag(26)	/* File locked with advisory lock */
 #define SIO_WARN	SmakeFlag(27)	/* Pending warning */
+#define SIO_ADAPTIVE	SmakeFlag(28)	/* Grow buffer for bulk I/O */
 #define SIO_CLEARERR	0	        /* Obsolete */
 #define SIO_REPXML	SmakeFlag(29)	/* Bad char --> XML entity */
 #define SIO_REPPL	SmakeFlag(30)	/* Bad char --> Prolog \hex\ */
@@ -389,6 +391,7 @@ PL_EXPORT(size_t)	Sfread(void *data, size_t size, size_t elems,
 			       IOSTREAM *s);
 PL_EXPORT(size_t)	Sfwrite(const void *data, size_t size, size_t elems,
 				IOSTREAM *s);
+PL_EXPORT(int64_t)	Scopy(IOSTREAM *in, IOSTREAM *out, int64_t len);
 PL_EXPORT(int)		Sfeof(IOSTREAM *s);
 PL_EXPORT(int)		Sfpasteof(IOSTREAM *s);
 PL_EXPORT(int)		Sferror(IOSTREAM *s);
@@ -409,7 +412,11 @@ PL_EXPORT(char *)	Sgets(char *buf);
 PL_EXPORT(ssize_t)	Sread_pending(IOSTREAM *s,
 				      char *buf, size_t limit, int flags);
 PL_EXPORT(size_t)	Spending(IOSTREAM *s);
+PL_EXPORT(size_t)	Sread_text(IOSTREAM *s, char *buf, size_t size,
+				   size_t *chars, const unsigned char *stop);
 PL_EXPORT(int)		Sfputs(const char *q, IOSTREAM *s);
+PL_EXPORT(int)		Sfputsn(const char *q, size_t len, IOSTREAM *s);
+PL_EXPORT(int)		Swrite_text(const char *utf8, size_t len, IOSTREAM *s);
 PL_EXPORT(int)		Sputs(const char *q);
 PL_EXPORT(int)		Sfprintf(IOSTREAM *s, const char *fm, ...);
 PL_EXPORT(int)		Sprintf(const char *fm, ...);
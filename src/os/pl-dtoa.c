@@ -79,3 +79,1089 @@ FREE_DTOA_LOCK(int n)
 #endif /*MULTIPLE_THREADS*/
 
 #include "dtoa.c"
+
+
+		 /*******************************
+		 *	  FAST CONVERSION	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+dtoa() and strtod() above are exact,  but   use  bignum  arithmetic.  The
+functions below handle the common cases using 64-bit integers only and
+return failure if they cannot  guarantee   the  result. The caller then
+falls back to dtoa() or strtod().
+
+fast_dtoa() implements Grisu3 (Florian  Loitsch, "Printing Floating-Point
+Numbers Quickly and Accurately with Integers",  PLDI 2010) for mode 0 of
+dtoa(): the shortest digit string that reads back as `d`, closest to `d`
+if there are multiple.  It fails for about 0.5% of the doubles.  `buf`
+must be at least FAST_DTOA_BUFSIZE bytes.
+
+fast_strtod() implements the  Eisel-Lemire   algorithm  (Daniel  Lemire,
+"Number Parsing at a Gigabyte per Second", 2021) for the text [s,e) that
+must be a decimal float with at most 19 significant digits. It fails if
+the text has more digits, the result  is   too  close to halfway between
+two doubles, or it overflows or is subnormal.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#ifdef _MSC_VER
+#define ULL(x) x ## ui64
+#else
+#define ULL(x) x ## ULL
+#endif
+
+typedef union
+{ double	d;
+  uint64_t	i;
+} dbl_bits;
+
+static inline void
+mul_64x64(uint64_t a, uint64_t b, uint64_t *hi, uint64_t *lo)
+{
+#ifdef __SIZEOF_INT128__
+  unsigned __int128 p = (unsigned __int128)a * b;
+
+  *hi = (uint64_t)(p>>64);
+  *lo = (uint64_t)p;
+#else
+  uint64_t a1 = a>>32, a0 = a&0xffffffff;
+  uint64_t b1 = b>>32, b0 = b&0xffffffff;
+  uint64_t p00 = a0*b0, p01 = a0*b1, p10 = a1*b0;
+  uint64_t mid = (p00>>32) + (p01&0xffffffff) + (p10&0xffffffff);
+
+  *hi = a1*b1 + (p01>>32) + (p10>>32) + (mid>>32);
+  *lo = (mid<<32) | (p00&0xffffffff);
+#endif
+}
+
+
+		 /*******************************
+		 *	       GRISU3		*
+		 *******************************/
+
+typedef struct diy_fp			/* f*2^e */
+{ uint64_t	f;
+  int		e;
+} diy_fp;
+
+typedef struct cached_power		/* f*2^e ~ 10^k */
+{ uint64_t	f;
+  int16_t	e;
+  int16_t	k;
+} cached_power;
+
+/* 10^k for k = -348, -340, ..., 340, rounded to nearest */
+
+static const cached_power cached_powers[] =
+{
+  { ULL(0xfa8fd5a0081c0288), -1220, -348 },
+  { ULL(0xbaaee17fa23ebf76), -1193, -340 },
+  { ULL(0x8b16fb203055ac76), -1166, -332 },
+  { ULL(0xcf42894a5dce35ea), -1140, -324 },
+  { ULL(0x9a6bb0aa55653b2d), -1113, -316 },
+  { ULL(0xe61acf033d1a45df), -1087, -308 },
+  { ULL(0xab70fe17c79ac6ca), -1060, -300 },
+  { ULL(0xff77b1fcbebcdc4f), -1034, -292 },
+  { ULL(0xbe5691ef416bd60c), -1007, -284 },
+  { ULL(0x8dd01fad907ffc3c),  -980, -276 },
+  { ULL(0xd3515c2831559a83),  -954, -268 },
+  { ULL(0x9d71ac8fada6c9b5),  -927, -260 },
+  { ULL(0xea9c227723ee8bcb),  -901, -252 },
+  { ULL(0xaecc49914078536d),  -874, -244 },
+  { ULL(0x823c12795db6ce57),  -847, -236 },
+  { ULL(0xc21094364dfb5637),  -821, -228 },
+  { ULL(0x9096ea6f3848984f),  -794, -220 },
+  { ULL(0xd77485cb25823ac7),  -768, -212 },
+  { ULL(0xa086cfcd97bf97f4),  -741, -204 },
+  { ULL(0xef340a98172aace5),  -715, -196 },
+  { ULL(0xb23867fb2a35b28e),  -688, -188 },
+  { ULL(0x84c8d4dfd2c63f3b),  -661, -180 },
+  { ULL(0xc5dd44271ad3cdba),  -635, -172 },
+  { ULL(0x936b9fcebb25c996),  -608, -164 },
+  { ULL(0xdbac6c247d62a584),  -582, -156 },
+  { ULL(0xa3ab66580d5fdaf6),  -555, -148 },
+  { ULL(0xf3e2f893dec3f126),  -529, -140 },
+  { ULL(0xb5b5ada8aaff80b8),  -502, -132 },
+  { ULL(0x87625f056c7c4a8b),  -475, -124 },
+  { ULL(0xc9bcff6034c13053),  -449, -116 },
+  { ULL(0x964e858c91ba2655),  -422, -108 },
+  { ULL(0xdff9772470297ebd),  -396, -100 },
+  { ULL(0xa6dfbd9fb8e5b88f),  -369,  -92 },
+  { ULL(0xf8a95fcf88747d94),  -343,  -84 },
+  { ULL(0xb94470938fa89bcf),  -316,  -76 },
+  { ULL(0x8a08f0f8bf0f156b),  -289,  -68 },
+  { ULL(0xcdb02555653131b6),  -263,  -60 },
+  { ULL(0x993fe2c6d07b7fac),  -236,  -52 },
+  { ULL(0xe45c10c42a2b3b06),  -210,  -44 },
+  { ULL(0xaa242499697392d3),  -183,  -36 },
+  { ULL(0xfd87b5f28300ca0e),  -157,  -28 },
+  { ULL(0xbce5086492111aeb),  -130,  -20 },
+  { ULL(0x8cbccc096f5088cc),  -103,  -12 },
+  { ULL(0xd1b71758e219652c),   -77,   -4 },
+  { ULL(0x9c40000000000000),   -50,    4 },
+  { ULL(0xe8d4a51000000000),   -24,   12 },
+  { ULL(0xad78ebc5ac620000),     3,   20 },
+  { ULL(0x813f3978f8940984),    30,   28 },
+  { ULL(0xc097ce7bc90715b3),    56,   36 },
+  { ULL(0x8f7e32ce7bea5c70),    83,   44 },
+  { ULL(0xd5d238a4abe98068),   109,   52 },
+  { ULL(0x9f4f2726179a2245),   136,   60 },
+  { ULL(0xed63a231d4c4fb27),   162,   68 },
+  { ULL(0xb0de65388cc8ada8),   189,   76 },
+  { ULL(0x83c7088e1aab65db),   216,   84 },
+  { ULL(0xc45d1df942711d9a),   242,   92 },
+  { ULL(0x924d692ca61be758),   269,  100 },
+  { ULL(0xda01ee641a708dea),   295,  108 },
+  { ULL(0xa26da3999aef774a),   322,  116 },
+  { ULL(0xf209787bb47d6b85),   348,  124 },
+  { ULL(0xb454e4a179dd1877),   375,  132 },
+  { ULL(0x865b86925b9bc5c2),   402,  140 },
+  { ULL(0xc83553c5c8965d3d),   428,  148 },
+  { ULL(0x952ab45cfa97a0b3),   455,  156 },
+  { ULL(0xde469fbd99a05fe3),   481,  164 },
+  { ULL(0xa59bc234db398c25),   508,  172 },
+  { ULL(0xf6c69a72a3989f5c),   534,  180 },
+  { ULL(0xb7dcbf5354e9bece),   561,  188 },
+  { ULL(0x88fcf317f22241e2),   588,  196 },
+  { ULL(0xcc20ce9bd35c78a5),   614,  204 },
+  { ULL(0x98165af37b2153df),   641,  212 },
+  { ULL(0xe2a0b5dc971f303a),   667,  220 },
+  { ULL(0xa8d9d1535ce3b396),   694,  228 },
+  { ULL(0xfb9b7cd9a4a7443c),   720,  236 },
+  { ULL(0xbb764c4ca7a44410),   747,  244 },
+  { ULL(0x8bab8eefb6409c1a),   774,  252 },
+  { ULL(0xd01fef10a657842c),   800,  260 },
+  { ULL(0x9b10a4e5e9913129),   827,  268 },
+  { ULL(0xe7109bfba19c0c9d),   853,  276 },
+  { ULL(0xac2820d9623bf429),   880,  284 },
+  { ULL(0x80444b5e7aa7cf85),   907,  292 },
+  { ULL(0xbf21e44003acdd2d),   933,  300 },
+  { ULL(0x8e679c2f5e44ff8f),   960,  308 },
+  { ULL(0xd433179d9c8cb841),   986,  316 },
+  { ULL(0x9e19db92b4e31ba9),  1013,  324 },
+  { ULL(0xeb96bf6ebadf77d9),  1039,  332 },
+  { ULL(0xaf87023b9bf0ee6b),  1066,  340 }
+};
+
+
+static inline diy_fp
+diy_mul(diy_fp x, diy_fp y)
+{ uint64_t hi, lo;
+  diy_fp r;
+
+  mul_64x64(x.f, y.f, &hi, &lo);
+  r.f = hi + (lo>>63);			/* round */
+  r.e = x.e + y.e + 64;
+
+  return r;
+}
+
+
+static inline diy_fp
+diy_normalize(diy_fp x)
+{ int shift = 63 - MSB64(x.f);
+
+  x.f <<= shift;
+  x.e -= shift;
+
+  return x;
+}
+
+
+static int
+round_weed(char *buf, int len,
+	   uint64_t dist_high_w, uint64_t unsafe, uint64_t rest,
+	   uint64_t ten_kappa, uint64_t unit)
+{ uint64_t small = dist_high_w - unit;
+  uint64_t big   = dist_high_w + unit;
+
+  while ( rest < small && unsafe - rest >= ten_kappa &&
+	  ( rest + ten_kappa < small ||
+	    small - rest >= rest + ten_kappa - small ) )
+  { buf[len-1]--;
+    rest += ten_kappa;
+  }
+
+  if ( rest < big && unsafe - rest >= ten_kappa &&
+       ( rest + ten_kappa < big ||
+	 big - rest > rest + ten_kappa - big ) )
+    return FALSE;
+
+  return 2*unit <= rest && rest <= unsafe - 4*unit;
+}
+
+
+static int
+digit_gen(diy_fp low, diy_fp w, diy_fp high, char *buf, int *len, int *kappa)
+{ static const uint32_t pow10[] =
+  { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+    1000000000
+  };
+  uint64_t unit     = 1;
+  uint64_t too_low  = low.f - unit;
+  uint64_t too_high = high.f + unit;
+  uint64_t unsafe   = too_high - too_low;
+  int shift	    = -w.e;
+  uint64_t one      = (uint64_t)1 << shift;
+  uint32_t integrals   = (uint32_t)(too_high >> shift);
+  uint64_t fractionals = too_high & (one-1);
+  uint32_t divisor;
+  int n = 0;
+  int k;
+
+  for(k = 10; k > 0 && pow10[k-1] > integrals; k--)
+    ;
+  divisor = k > 0 ? pow10[k-1] : 0;
+
+  while( k > 0 )
+  { uint64_t rest;
+
+    buf[n++] = (char)('0' + integrals/divisor);
+    integrals %= divisor;
+    k--;
+    rest = ((uint64_t)integrals << shift) + fractionals;
+    if ( rest < unsafe )
+    { *len = n;
+      *kappa = k;
+      return round_weed(buf, n, too_high - w.f, unsafe, rest,
+			(uint64_t)divisor << shift, unit);
+    }
+    divisor /= 10;
+  }
+
+  for(;;)
+  { fractionals *= 10;
+    unit *= 10;
+    unsafe *= 10;
+    buf[n++] = (char)('0' + (fractionals >> shift));
+    fractionals &= one-1;
+    k--;
+    if ( fractionals < unsafe )
+    { *len = n;
+      *kappa = k;
+      return round_weed(buf, n, (too_high - w.f)*unit, unsafe, fractionals,
+			one, unit);
+    }
+  }
+}
+
+
+char *
+fast_dtoa(double d, char *buf, int *decpt, int *sign, char **rve)
+{ dbl_bits u;
+  uint64_t frac;
+  int bexp, k, len, kappa;
+  diy_fp w, m_plus, m_minus, c;
+  const cached_power *cp;
+
+  u.d = d;
+  *sign = (int)(u.i>>63);
+  bexp  = (int)((u.i>>52) & 0x7ff);
+  frac  = u.i & ((ULL(1)<<52)-1);
+
+  if ( bexp == 0x7ff )			/* Inf, NaN */
+    return NULL;
+  if ( bexp == 0 && frac == 0 )
+  { buf[0] = '0';
+    buf[1] = EOS;
+    *decpt = 1;
+    *rve = buf+1;
+    return buf;
+  }
+
+  if ( bexp )
+  { w.f = frac | (ULL(1)<<52);
+    w.e = bexp - 1075;
+  } else				/* subnormal */
+  { w.f = frac;
+    w.e = -1074;
+  }
+					/* boundaries m-, m+ */
+  m_plus.f = (w.f<<1) + 1;
+  m_plus.e = w.e - 1;
+  m_plus = diy_normalize(m_plus);
+  if ( frac == 0 && bexp > 1 )
+  { m_minus.f = (w.f<<2) - 1;
+    m_minus.e = w.e - 2;
+  } else
+  { m_minus.f = (w.f<<1) - 1;
+    m_minus.e = w.e - 1;
+  }
+  m_minus.f <<= m_minus.e - m_plus.e;
+  m_minus.e = m_plus.e;
+  w = diy_normalize(w);
+					/* scale such that -60 <= e <= -32 */
+  k  = (int)ceil((-61 - w.e) * 0.30102999566398114);
+  cp = &cached_powers[(348 + k - 1)/8 + 1];
+  c.f = cp->f;
+  c.e = cp->e;
+
+  if ( !digit_gen(diy_mul(m_minus, c), diy_mul(w, c), diy_mul(m_plus, c),
+		  buf, &len, &kappa) )
+    return NULL;
+
+  buf[len] = EOS;
+  *decpt = len + kappa - cp->k;
+  *rve = buf+len;
+
+  return buf;
+}
+
+
+		 /*******************************
+		 *	    EISEL-LEMIRE	*
+		 *******************************/
+
+/* pow10_128[e-POW10_MIN] is 10^e as 128-bit mantissa, rounded down */
+
+#define POW10_MIN (-342)
+#define POW10_MAX 308
+
+static const uint64_t pow10_128[][2] =
+{
+  { ULL(0xeef453d6923bd65a), ULL(0x113faa2906a13b3f) },
+  { ULL(0x9558b4661b6565f8), ULL(0x4ac7ca59a424c507) },
+  { ULL(0xbaaee17fa23ebf76), ULL(0x5d79bcf00d2df649) },
+  { ULL(0xe95a99df8ace6f53), ULL(0xf4d82c2c107973dc) },
+  { ULL(0x91d8a02bb6c10594), ULL(0x79071b9b8a4be869) },
+  { ULL(0xb64ec836a47146f9), ULL(0x9748e2826cdee284) },
+  { ULL(0xe3e27a444d8d98b7), ULL(0xfd1b1b2308169b25) },
+  { ULL(0x8e6d8c6ab0787f72), ULL(0xfe30f0f5e50e20f7) },
+  { ULL(0xb208ef855c969f4f), ULL(0xbdbd2d335e51a935) },
+  { ULL(0xde8b2b66b3bc4723), ULL(0xad2c788035e61382) },
+  { ULL(0x8b16fb203055ac76), ULL(0x4c3bcb5021afcc31) },
+  { ULL(0xaddcb9e83c6b1793), ULL(0xdf4abe242a1bbf3d) },
+  { ULL(0xd953e8624b85dd78), ULL(0xd71d6dad34a2af0d) },
+  { ULL(0x87d4713d6f33aa6b), ULL(0x8672648c40e5ad68) },
+  { ULL(0xa9c98d8ccb009506), ULL(0x680efdaf511f18c2) },
+  { ULL(0xd43bf0effdc0ba48), ULL(0x0212bd1b2566def2) },
+  { ULL(0x84a57695fe98746d), ULL(0x014bb630f7604b57) },
+  { ULL(0xa5ced43b7e3e9188), ULL(0x419ea3bd35385e2d) },
+  { ULL(0xcf42894a5dce35ea), ULL(0x52064cac828675b9) },
+  { ULL(0x818995ce7aa0e1b2), ULL(0x7343efebd1940993) },
+  { ULL(0xa1ebfb4219491a1f), ULL(0x1014ebe6c5f90bf8) },
+  { ULL(0xca66fa129f9b60a6), ULL(0xd41a26e077774ef6) },
+  { ULL(0xfd00b897478238d0), ULL(0x8920b098955522b4) },
+  { ULL(0x9e20735e8cb16382), ULL(0x55b46e5f5d5535b0) },
+  { ULL(0xc5a890362fddbc62), ULL(0xeb2189f734aa831d) },
+  { ULL(0xf712b443bbd52b7b), ULL(0xa5e9ec7501d523e4) },
+  { ULL(0x9a6bb0aa55653b2d), ULL(0x47b233c92125366e) },
+  { ULL(0xc1069cd4eabe89f8), ULL(0x999ec0bb696e840a) },
+  { ULL(0xf148440a256e2c76), ULL(0xc00670ea43ca250d) },
+  { ULL(0x96cd2a865764dbca), ULL(0x380406926a5e5728) },
+  { ULL(0xbc807527ed3e12bc), ULL(0xc605083704f5ecf2) },
+  { ULL(0xeba09271e88d976b), ULL(0xf7864a44c633682e) },
+  { ULL(0x93445b8731587ea3), ULL(0x7ab3ee6afbe0211d) },
+  { ULL(0xb8157268fdae9e4c), ULL(0x5960ea05bad82964) },
+  { ULL(0xe61acf033d1a45df), ULL(0x6fb92487298e33bd) },
+  { ULL(0x8fd0c16206306bab), ULL(0xa5d3b6d479f8e056) },
+  { ULL(0xb3c4f1ba87bc8696), ULL(0x8f48a4899877186c) },
+  { ULL(0xe0b62e2929aba83c), ULL(0x331acdabfe94de87) },
+  { ULL(0x8c71dcd9ba0b4925), ULL(0x9ff0c08b7f1d0b14) },
+  { ULL(0xaf8e5410288e1b6f), ULL(0x07ecf0ae5ee44dd9) },
+  { ULL(0xdb71e91432b1a24a), ULL(0xc9e82cd9f69d6150) },
+  { ULL(0x892731ac9faf056e), ULL(0xbe311c083a225cd2) },
+  { ULL(0xab70fe17c79ac6ca), ULL(0x6dbd630a48aaf406) },
+  { ULL(0xd64d3d9db981787d), ULL(0x092cbbccdad5b108) },
+  { ULL(0x85f0468293f0eb4e), ULL(0x25bbf56008c58ea5) },
+  { ULL(0xa76c582338ed2621), ULL(0xaf2af2b80af6f24e) },
+  { ULL(0xd1476e2c07286faa), ULL(0x1af5af660db4aee1) },
+  { ULL(0x82cca4db847945ca), ULL(0x50d98d9fc890ed4d) },
+  { ULL(0xa37fce126597973c), ULL(0xe50ff107bab528a0) },
+  { ULL(0xcc5fc196fefd7d0c), ULL(0x1e53ed49a96272c8) },
+  { ULL(0xff77b1fcbebcdc4f), ULL(0x25e8e89c13bb0f7a) },
+  { ULL(0x9faacf3df73609b1), ULL(0x77b191618c54e9ac) },
+  { ULL(0xc795830d75038c1d), ULL(0xd59df5b9ef6a2417) },
+  { ULL(0xf97ae3d0d2446f25), ULL(0x4b0573286b44ad1d) },
+  { ULL(0x9becce62836ac577), ULL(0x4ee367f9430aec32) },
+  { ULL(0xc2e801fb244576d5), ULL(0x229c41f793cda73f) },
+  { ULL(0xf3a20279ed56d48a), ULL(0x6b43527578c1110f) },
+  { ULL(0x9845418c345644d6), ULL(0x830a13896b78aaa9) },
+  { ULL(0xbe5691ef416bd60c), ULL(0x23cc986bc656d553) },
+  { ULL(0xedec366b11c6cb8f), ULL(0x2cbfbe86b7ec8aa8) },
+  { ULL(0x94b3a202eb1c3f39), ULL(0x7bf7d71432f3d6a9) },
+  { ULL(0xb9e08a83a5e34f07), ULL(0xdaf5ccd93fb0cc53) },
+  { ULL(0xe858ad248f5c22c9), ULL(0xd1b3400f8f9cff68) },
+  { ULL(0x91376c36d99995be), ULL(0x23100809b9c21fa1) },
+  { ULL(0xb58547448ffffb2d), ULL(0xabd40a0c2832a78a) },
+  { ULL(0xe2e69915b3fff9f9), ULL(0x16c90c8f323f516c) },
+  { ULL(0x8dd01fad907ffc3b), ULL(0xae3da7d97f6792e3) },
+  { ULL(0xb1442798f49ffb4a), ULL(0x99cd11cfdf41779c) },
+  { ULL(0xdd95317f31c7fa1d), ULL(0x40405643d711d583) },
+  { ULL(0x8a7d3eef7f1cfc52), ULL(0x482835ea666b2572) },
+  { ULL(0xad1c8eab5ee43b66), ULL(0xda3243650005eecf) },
+  { ULL(0xd863b256369d4a40), ULL(0x90bed43e40076a82) },
+  { ULL(0x873e4f75e2224e68), ULL(0x5a7744a6e804a291) },
+  { ULL(0xa90de3535aaae202), ULL(0x711515d0a205cb36) },
+  { ULL(0xd3515c2831559a83), ULL(0x0d5a5b44ca873e03) },
+  { ULL(0x8412d9991ed58091), ULL(0xe858790afe9486c2) },
+  { ULL(0xa5178fff668ae0b6), ULL(0x626e974dbe39a872) },
+  { ULL(0xce5d73ff402d98e3), ULL(0xfb0a3d212dc8128f) },
+  { ULL(0x80fa687f881c7f8e), ULL(0x7ce66634bc9d0b99) },
+  { ULL(0xa139029f6a239f72), ULL(0x1c1fffc1ebc44e80) },
+  { ULL(0xc987434744ac874e), ULL(0xa327ffb266b56220) },
+  { ULL(0xfbe9141915d7a922), ULL(0x4bf1ff9f0062baa8) },
+  { ULL(0x9d71ac8fada6c9b5), ULL(0x6f773fc3603db4a9) },
+  { ULL(0xc4ce17b399107c22), ULL(0xcb550fb4384d21d3) },
+  { ULL(0xf6019da07f549b2b), ULL(0x7e2a53a146606a48) },
+  { ULL(0x99c102844f94e0fb), ULL(0x2eda7444cbfc426d) },
+  { ULL(0xc0314325637a1939), ULL(0xfa911155fefb5308) },
+  { ULL(0xf03d93eebc589f88), ULL(0x793555ab7eba27ca) },
+  { ULL(0x96267c7535b763b5), ULL(0x4bc1558b2f3458de) },
+  { ULL(0xbbb01b9283253ca2), ULL(0x9eb1aaedfb016f16) },
+  { ULL(0xea9c227723ee8bcb), ULL(0x465e15a979c1cadc) },
+  { ULL(0x92a1958a7675175f), ULL(0x0bfacd89ec191ec9) },
+  { ULL(0xb749faed14125d36), ULL(0xcef980ec671f667b) },
+  { ULL(0xe51c79a85916f484), ULL(0x82b7e12780e7401a) },
+  { ULL(0x8f31cc0937ae58d2), ULL(0xd1b2ecb8b0908810) },
+  { ULL(0xb2fe3f0b8599ef07), ULL(0x861fa7e6dcb4aa15) },
+  { ULL(0xdfbdcece67006ac9), ULL(0x67a791e093e1d49a) },
+  { ULL(0x8bd6a141006042bd), ULL(0xe0c8bb2c5c6d24e0) },
+  { ULL(0xaecc49914078536d), ULL(0x58fae9f773886e18) },
+  { ULL(0xda7f5bf590966848), ULL(0xaf39a475506a899e) },
+  { ULL(0x888f99797a5e012d), ULL(0x6d8406c952429603) },
+  { ULL(0xaab37fd7d8f58178), ULL(0xc8e5087ba6d33b83) },
+  { ULL(0xd5605fcdcf32e1d6), ULL(0xfb1e4a9a90880a64) },
+  { ULL(0x855c3be0a17fcd26), ULL(0x5cf2eea09a55067f) },
+  { ULL(0xa6b34ad8c9dfc06f), ULL(0xf42faa48c0ea481e) },
+  { ULL(0xd0601d8efc57b08b), ULL(0xf13b94daf124da26) },
+  { ULL(0x823c12795db6ce57), ULL(0x76c53d08d6b70858) },
+  { ULL(0xa2cb1717b52481ed), ULL(0x54768c4b0c64ca6e) },
+  { ULL(0xcb7ddcdda26da268), ULL(0xa9942f5dcf7dfd09) },
+  { ULL(0xfe5d54150b090b02), ULL(0xd3f93b35435d7c4c) },
+  { ULL(0x9efa548d26e5a6e1), ULL(0xc47bc5014a1a6daf) },
+  { ULL(0xc6b8e9b0709f109a), ULL(0x359ab6419ca1091b) },
+  { ULL(0xf867241c8cc6d4c0), ULL(0xc30163d203c94b62) },
+  { ULL(0x9b407691d7fc44f8), ULL(0x79e0de63425dcf1d) },
+  { ULL(0xc21094364dfb5636), ULL(0x985915fc12f542e4) },
+  { ULL(0xf294b943e17a2bc4), ULL(0x3e6f5b7b17b2939d) },
+  { ULL(0x979cf3ca6cec5b5a), ULL(0xa705992ceecf9c42) },
+  { ULL(0xbd8430bd08277231), ULL(0x50c6ff782a838353) },
+  { ULL(0xece53cec4a314ebd), ULL(0xa4f8bf5635246428) },
+  { ULL(0x940f4613ae5ed136), ULL(0x871b7795e136be99) },
+  { ULL(0xb913179899f68584), ULL(0x28e2557b59846e3f) },
+  { ULL(0xe757dd7ec07426e5), ULL(0x331aeada2fe589cf) },
+  { ULL(0x9096ea6f3848984f), ULL(0x3ff0d2c85def7621) },
+  { ULL(0xb4bca50b065abe63), ULL(0x0fed077a756b53a9) },
+  { ULL(0xe1ebce4dc7f16dfb), ULL(0xd3e8495912c62894) },
+  { ULL(0x8d3360f09cf6e4bd), ULL(0x64712dd7abbbd95c) },
+  { ULL(0xb080392cc4349dec), ULL(0xbd8d794d96aacfb3) },
+  { ULL(0xdca04777f541c567), ULL(0xecf0d7a0fc5583a0) },
+  { ULL(0x89e42caaf9491b60), ULL(0xf41686c49db57244) },
+  { ULL(0xac5d37d5b79b6239), ULL(0x311c2875c522ced5) },
+  { ULL(0xd77485cb25823ac7), ULL(0x7d633293366b828b) },
+  { ULL(0x86a8d39ef77164bc), ULL(0xae5dff9c02033197) },
+  { ULL(0xa8530886b54dbdeb), ULL(0xd9f57f830283fdfc) },
+  { ULL(0xd267caa862a12d66), ULL(0xd072df63c324fd7b) },
+  { ULL(0x8380dea93da4bc60), ULL(0x4247cb9e59f71e6d) },
+  { ULL(0xa46116538d0deb78), ULL(0x52d9be85f074e608) },
+  { ULL(0xcd795be870516656), ULL(0x67902e276c921f8b) },
+  { ULL(0x806bd9714632dff6), ULL(0x00ba1cd8a3db53b6) },
+  { ULL(0xa086cfcd97bf97f3), ULL(0x80e8a40eccd228a4) },
+  { ULL(0xc8a883c0fdaf7df0), ULL(0x6122cd128006b2cd) },
+  { ULL(0xfad2a4b13d1b5d6c), ULL(0x796b805720085f81) },
+  { ULL(0x9cc3a6eec6311a63), ULL(0xcbe3303674053bb0) },
+  { ULL(0xc3f490aa77bd60fc), ULL(0xbedbfc4411068a9c) },
+  { ULL(0xf4f1b4d515acb93b), ULL(0xee92fb5515482d44) },
+  { ULL(0x991711052d8bf3c5), ULL(0x751bdd152d4d1c4a) },
+  { ULL(0xbf5cd54678eef0b6), ULL(0xd262d45a78a0635d) },
+  { ULL(0xef340a98172aace4), ULL(0x86fb897116c87c34) },
+  { ULL(0x9580869f0e7aac0e), ULL(0xd45d35e6ae3d4da0) },
+  { ULL(0xbae0a846d2195712), ULL(0x8974836059cca109) },
+  { ULL(0xe998d258869facd7), ULL(0x2bd1a438703fc94b) },
+  { ULL(0x91ff83775423cc06), ULL(0x7b6306a34627ddcf) },
+  { ULL(0xb67f6455292cbf08), ULL(0x1a3bc84c17b1d542) },
+  { ULL(0xe41f3d6a7377eeca), ULL(0x20caba5f1d9e4a93) },
+  { ULL(0x8e938662882af53e), ULL(0x547eb47b7282ee9c) },
+  { ULL(0xb23867fb2a35b28d), ULL(0xe99e619a4f23aa43) },
+  { ULL(0xdec681f9f4c31f31), ULL(0x6405fa00e2ec94d4) },
+  { ULL(0x8b3c113c38f9f37e), ULL(0xde83bc408dd3dd04) },
+  { ULL(0xae0b158b4738705e), ULL(0x9624ab50b148d445) },
+  { ULL(0xd98ddaee19068c76), ULL(0x3badd624dd9b0957) },
+  { ULL(0x87f8a8d4cfa417c9), ULL(0xe54ca5d70a80e5d6) },
+  { ULL(0xa9f6d30a038d1dbc), ULL(0x5e9fcf4ccd211f4c) },
+  { ULL(0xd47487cc8470652b), ULL(0x7647c3200069671f) },
+  { ULL(0x84c8d4dfd2c63f3b), ULL(0x29ecd9f40041e073) },
+  { ULL(0xa5fb0a17c777cf09), ULL(0xf468107100525890) },
+  { ULL(0xcf79cc9db955c2cc), ULL(0x7182148d4066eeb4) },
+  { ULL(0x81ac1fe293d599bf), ULL(0xc6f14cd848405530) },
+  { ULL(0xa21727db38cb002f), ULL(0xb8ada00e5a506a7c) },
+  { ULL(0xca9cf1d206fdc03b), ULL(0xa6d90811f0e4851c) },
+  { ULL(0xfd442e4688bd304a), ULL(0x908f4a166d1da663) },
+  { ULL(0x9e4a9cec15763e2e), ULL(0x9a598e4e043287fe) },
+  { ULL(0xc5dd44271ad3cdba), ULL(0x40eff1e1853f29fd) },
+  { ULL(0xf7549530e188c128), ULL(0xd12bee59e68ef47c) },
+  { ULL(0x9a94dd3e8cf578b9), ULL(0x82bb74f8301958ce) },
+  { ULL(0xc13a148e3032d6e7), ULL(0xe36a52363c1faf01) },
+  { ULL(0xf18899b1bc3f8ca1), ULL(0xdc44e6c3cb279ac1) },
+  { ULL(0x96f5600f15a7b7e5), ULL(0x29ab103a5ef8c0b9) },
+  { ULL(0xbcb2b812db11a5de), ULL(0x7415d448f6b6f0e7) },
+  { ULL(0xebdf661791d60f56), ULL(0x111b495b3464ad21) },
+  { ULL(0x936b9fcebb25c995), ULL(0xcab10dd900beec34) },
+  { ULL(0xb84687c269ef3bfb), ULL(0x3d5d514f40eea742) },
+  { ULL(0xe65829b3046b0afa), ULL(0x0cb4a5a3112a5112) },
+  { ULL(0x8ff71a0fe2c2e6dc), ULL(0x47f0e785eaba72ab) },
+  { ULL(0xb3f4e093db73a093), ULL(0x59ed216765690f56) },
+  { ULL(0xe0f218b8d25088b8), ULL(0x306869c13ec3532c) },
+  { ULL(0x8c974f7383725573), ULL(0x1e414218c73a13fb) },
+  { ULL(0xafbd2350644eeacf), ULL(0xe5d1929ef90898fa) },
+  { ULL(0xdbac6c247d62a583), ULL(0xdf45f746b74abf39) },
+  { ULL(0x894bc396ce5da772), ULL(0x6b8bba8c328eb783) },
+  { ULL(0xab9eb47c81f5114f), ULL(0x066ea92f3f326564) },
+  { ULL(0xd686619ba27255a2), ULL(0xc80a537b0efefebd) },
+  { ULL(0x8613fd0145877585), ULL(0xbd06742ce95f5f36) },
+  { ULL(0xa798fc4196e952e7), ULL(0x2c48113823b73704) },
+  { ULL(0xd17f3b51fca3a7a0), ULL(0xf75a15862ca504c5) },
+  { ULL(0x82ef85133de648c4), ULL(0x9a984d73dbe722fb) },
+  { ULL(0xa3ab66580d5fdaf5), ULL(0xc13e60d0d2e0ebba) },
+  { ULL(0xcc963fee10b7d1b3), ULL(0x318df905079926a8) },
+  { ULL(0xffbbcfe994e5c61f), ULL(0xfdf17746497f7052) },
+  { ULL(0x9fd561f1fd0f9bd3), ULL(0xfeb6ea8bedefa633) },
+  { ULL(0xc7caba6e7c5382c8), ULL(0xfe64a52ee96b8fc0) },
+  { ULL(0xf9bd690a1b68637b), ULL(0x3dfdce7aa3c673b0) },
+  { ULL(0x9c1661a651213e2d), ULL(0x06bea10ca65c084e) },
+  { ULL(0xc31bfa0fe5698db8), ULL(0x486e494fcff30a62) },
+  { ULL(0xf3e2f893dec3f126), ULL(0x5a89dba3c3efccfa) },
+  { ULL(0x986ddb5c6b3a76b7), ULL(0xf89629465a75e01c) },
+  { ULL(0xbe89523386091465), ULL(0xf6bbb397f1135823) },
+  { ULL(0xee2ba6c0678b597f), ULL(0x746aa07ded582e2c) },
+  { ULL(0x94db483840b717ef), ULL(0xa8c2a44eb4571cdc) },
+  { ULL(0xba121a4650e4ddeb), ULL(0x92f34d62616ce413) },
+  { ULL(0xe896a0d7e51e1566), ULL(0x77b020baf9c81d17) },
+  { ULL(0x915e2486ef32cd60), ULL(0x0ace1474dc1d122e) },
+  { ULL(0xb5b5ada8aaff80b8), ULL(0x0d819992132456ba) },
+  { ULL(0xe3231912d5bf60e6), ULL(0x10e1fff697ed6c69) },
+  { ULL(0x8df5efabc5979c8f), ULL(0xca8d3ffa1ef463c1) },
+  { ULL(0xb1736b96b6fd83b3), ULL(0xbd308ff8a6b17cb2) },
+  { ULL(0xddd0467c64bce4a0), ULL(0xac7cb3f6d05ddbde) },
+  { ULL(0x8aa22c0dbef60ee4), ULL(0x6bcdf07a423aa96b) },
+  { ULL(0xad4ab7112eb3929d), ULL(0x86c16c98d2c953c6) },
+  { ULL(0xd89d64d57a607744), ULL(0xe871c7bf077ba8b7) },
+  { ULL(0x87625f056c7c4a8b), ULL(0x11471cd764ad4972) },
+  { ULL(0xa93af6c6c79b5d2d), ULL(0xd598e40d3dd89bcf) },
+  { ULL(0xd389b47879823479), ULL(0x4aff1d108d4ec2c3) },
+  { ULL(0x843610cb4bf160cb), ULL(0xcedf722a585139ba) },
+  { ULL(0xa54394fe1eedb8fe), ULL(0xc2974eb4ee658828) },
+  { ULL(0xce947a3da6a9273e), ULL(0x733d226229feea32) },
+  { ULL(0x811ccc668829b887), ULL(0x0806357d5a3f525f) },
+  { ULL(0xa163ff802a3426a8), ULL(0xca07c2dcb0cf26f7) },
+  { ULL(0xc9bcff6034c13052), ULL(0xfc89b393dd02f0b5) },
+  { ULL(0xfc2c3f3841f17c67), ULL(0xbbac2078d443ace2) },
+  { ULL(0x9d9ba7832936edc0), ULL(0xd54b944b84aa4c0d) },
+  { ULL(0xc5029163f384a931), ULL(0x0a9e795e65d4df11) },
+  { ULL(0xf64335bcf065d37d), ULL(0x4d4617b5ff4a16d5) },
+  { ULL(0x99ea0196163fa42e), ULL(0x504bced1bf8e4e45) },
+  { ULL(0xc06481fb9bcf8d39), ULL(0xe45ec2862f71e1d6) },
+  { ULL(0xf07da27a82c37088), ULL(0x5d767327bb4e5a4c) },
+  { ULL(0x964e858c91ba2655), ULL(0x3a6a07f8d510f86f) },
+  { ULL(0xbbe226efb628afea), ULL(0x890489f70a55368b) },
+  { ULL(0xeadab0aba3b2dbe5), ULL(0x2b45ac74ccea842e) },
+  { ULL(0x92c8ae6b464fc96f), ULL(0x3b0b8bc90012929d) },
+  { ULL(0xb77ada0617e3bbcb), ULL(0x09ce6ebb40173744) },
+  { ULL(0xe55990879ddcaabd), ULL(0xcc420a6a101d0515) },
+  { ULL(0x8f57fa54c2a9eab6), ULL(0x9fa946824a12232d) },
+  { ULL(0xb32df8e9f3546564), ULL(0x47939822dc96abf9) },
+  { ULL(0xdff9772470297ebd), ULL(0x59787e2b93bc56f7) },
+  { ULL(0x8bfbea76c619ef36), ULL(0x57eb4edb3c55b65a) },
+  { ULL(0xaefae51477a06b03), ULL(0xede622920b6b23f1) },
+  { ULL(0xdab99e59958885c4), ULL(0xe95fab368e45eced) },
+  { ULL(0x88b402f7fd75539b), ULL(0x11dbcb0218ebb414) },
+  { ULL(0xaae103b5fcd2a881), ULL(0xd652bdc29f26a119) },
+  { ULL(0xd59944a37c0752a2), ULL(0x4be76d3346f0495f) },
+  { ULL(0x857fcae62d8493a5), ULL(0x6f70a4400c562ddb) },
+  { ULL(0xa6dfbd9fb8e5b88e), ULL(0xcb4ccd500f6bb952) },
+  { ULL(0xd097ad07a71f26b2), ULL(0x7e2000a41346a7a7) },
+  { ULL(0x825ecc24c873782f), ULL(0x8ed400668c0c28c8) },
+  { ULL(0xa2f67f2dfa90563b), ULL(0x728900802f0f32fa) },
+  { ULL(0xcbb41ef979346bca), ULL(0x4f2b40a03ad2ffb9) },
+  { ULL(0xfea126b7d78186bc), ULL(0xe2f610c84987bfa8) },
+  { ULL(0x9f24b832e6b0f436), ULL(0x0dd9ca7d2df4d7c9) },
+  { ULL(0xc6ede63fa05d3143), ULL(0x91503d1c79720dbb) },
+  { ULL(0xf8a95fcf88747d94), ULL(0x75a44c6397ce912a) },
+  { ULL(0x9b69dbe1b548ce7c), ULL(0xc986afbe3ee11aba) },
+  { ULL(0xc24452da229b021b), ULL(0xfbe85badce996168) },
+  { ULL(0xf2d56790ab41c2a2), ULL(0xfae27299423fb9c3) },
+  { ULL(0x97c560ba6b0919a5), ULL(0xdccd879fc967d41a) },
+  { ULL(0xbdb6b8e905cb600f), ULL(0x5400e987bbc1c920) },
+  { ULL(0xed246723473e3813), ULL(0x290123e9aab23b68) },
+  { ULL(0x9436c0760c86e30b), ULL(0xf9a0b6720aaf6521) },
+  { ULL(0xb94470938fa89bce), ULL(0xf808e40e8d5b3e69) },
+  { ULL(0xe7958cb87392c2c2), ULL(0xb60b1d1230b20e04) },
+  { ULL(0x90bd77f3483bb9b9), ULL(0xb1c6f22b5e6f48c2) },
+  { ULL(0xb4ecd5f01a4aa828), ULL(0x1e38aeb6360b1af3) },
+  { ULL(0xe2280b6c20dd5232), ULL(0x25c6da63c38de1b0) },
+  { ULL(0x8d590723948a535f), ULL(0x579c487e5a38ad0e) },
+  { ULL(0xb0af48ec79ace837), ULL(0x2d835a9df0c6d851) },
+  { ULL(0xdcdb1b2798182244), ULL(0xf8e431456cf88e65) },
+  { ULL(0x8a08f0f8bf0f156b), ULL(0x1b8e9ecb641b58ff) },
+  { ULL(0xac8b2d36eed2dac5), ULL(0xe272467e3d222f3f) },
+  { ULL(0xd7adf884aa879177), ULL(0x5b0ed81dcc6abb0f) },
+  { ULL(0x86ccbb52ea94baea), ULL(0x98e947129fc2b4e9) },
+  { ULL(0xa87fea27a539e9a5), ULL(0x3f2398d747b36224) },
+  { ULL(0xd29fe4b18e88640e), ULL(0x8eec7f0d19a03aad) },
+  { ULL(0x83a3eeeef9153e89), ULL(0x1953cf68300424ac) },
+  { ULL(0xa48ceaaab75a8e2b), ULL(0x5fa8c3423c052dd7) },
+  { ULL(0xcdb02555653131b6), ULL(0x3792f412cb06794d) },
+  { ULL(0x808e17555f3ebf11), ULL(0xe2bbd88bbee40bd0) },
+  { ULL(0xa0b19d2ab70e6ed6), ULL(0x5b6aceaeae9d0ec4) },
+  { ULL(0xc8de047564d20a8b), ULL(0xf245825a5a445275) },
+  { ULL(0xfb158592be068d2e), ULL(0xeed6e2f0f0d56712) },
+  { ULL(0x9ced737bb6c4183d), ULL(0x55464dd69685606b) },
+  { ULL(0xc428d05aa4751e4c), ULL(0xaa97e14c3c26b886) },
+  { ULL(0xf53304714d9265df), ULL(0xd53dd99f4b3066a8) },
+  { ULL(0x993fe2c6d07b7fab), ULL(0xe546a8038efe4029) },
+  { ULL(0xbf8fdb78849a5f96), ULL(0xde98520472bdd033) },
+  { ULL(0xef73d256a5c0f77c), ULL(0x963e66858f6d4440) },
+  { ULL(0x95a8637627989aad), ULL(0xdde7001379a44aa8) },
+  { ULL(0xbb127c53b17ec159), ULL(0x5560c018580d5d52) },
+  { ULL(0xe9d71b689dde71af), ULL(0xaab8f01e6e10b4a6) },
+  { ULL(0x9226712162ab070d), ULL(0xcab3961304ca70e8) },
+  { ULL(0xb6b00d69bb55c8d1), ULL(0x3d607b97c5fd0d22) },
+  { ULL(0xe45c10c42a2b3b05), ULL(0x8cb89a7db77c506a) },
+  { ULL(0x8eb98a7a9a5b04e3), ULL(0x77f3608e92adb242) },
+  { ULL(0xb267ed1940f1c61c), ULL(0x55f038b237591ed3) },
+  { ULL(0xdf01e85f912e37a3), ULL(0x6b6c46dec52f6688) },
+  { ULL(0x8b61313bbabce2c6), ULL(0x2323ac4b3b3da015) },
+  { ULL(0xae397d8aa96c1b77), ULL(0xabec975e0a0d081a) },
+  { ULL(0xd9c7dced53c72255), ULL(0x96e7bd358c904a21) },
+  { ULL(0x881cea14545c7575), ULL(0x7e50d64177da2e54) },
+  { ULL(0xaa242499697392d2), ULL(0xdde50bd1d5d0b9e9) },
+  { ULL(0xd4ad2dbfc3d07787), ULL(0x955e4ec64b44e864) },
+  { ULL(0x84ec3c97da624ab4), ULL(0xbd5af13bef0b113e) },
+  { ULL(0xa6274bbdd0fadd61), ULL(0xecb1ad8aeacdd58e) },
+  { ULL(0xcfb11ead453994ba), ULL(0x67de18eda5814af2) },
+  { ULL(0x81ceb32c4b43fcf4), ULL(0x80eacf948770ced7) },
+  { ULL(0xa2425ff75e14fc31), ULL(0xa1258379a94d028d) },
+  { ULL(0xcad2f7f5359a3b3e), ULL(0x096ee45813a04330) },
+  { ULL(0xfd87b5f28300ca0d), ULL(0x8bca9d6e188853fc) },
+  { ULL(0x9e74d1b791e07e48), ULL(0x775ea264cf55347d) },
+  { ULL(0xc612062576589dda), ULL(0x95364afe032a819d) },
+  { ULL(0xf79687aed3eec551), ULL(0x3a83ddbd83f52204) },
+  { ULL(0x9abe14cd44753b52), ULL(0xc4926a9672793542) },
+  { ULL(0xc16d9a0095928a27), ULL(0x75b7053c0f178293) },
+  { ULL(0xf1c90080baf72cb1), ULL(0x5324c68b12dd6338) },
+  { ULL(0x971da05074da7bee), ULL(0xd3f6fc16ebca5e03) },
+  { ULL(0xbce5086492111aea), ULL(0x88f4bb1ca6bcf584) },
+  { ULL(0xec1e4a7db69561a5), ULL(0x2b31e9e3d06c32e5) },
+  { ULL(0x9392ee8e921d5d07), ULL(0x3aff322e62439fcf) },
+  { ULL(0xb877aa3236a4b449), ULL(0x09befeb9fad487c2) },
+  { ULL(0xe69594bec44de15b), ULL(0x4c2ebe687989a9b3) },
+  { ULL(0x901d7cf73ab0acd9), ULL(0x0f9d37014bf60a10) },
+  { ULL(0xb424dc35095cd80f), ULL(0x538484c19ef38c94) },
+  { ULL(0xe12e13424bb40e13), ULL(0x2865a5f206b06fb9) },
+  { ULL(0x8cbccc096f5088cb), ULL(0xf93f87b7442e45d3) },
+  { ULL(0xafebff0bcb24aafe), ULL(0xf78f69a51539d748) },
+  { ULL(0xdbe6fecebdedd5be), ULL(0xb573440e5a884d1b) },
+  { ULL(0x89705f4136b4a597), ULL(0x31680a88f8953030) },
+  { ULL(0xabcc77118461cefc), ULL(0xfdc20d2b36ba7c3d) },
+  { ULL(0xd6bf94d5e57a42bc), ULL(0x3d32907604691b4c) },
+  { ULL(0x8637bd05af6c69b5), ULL(0xa63f9a49c2c1b10f) },
+  { ULL(0xa7c5ac471b478423), ULL(0x0fcf80dc33721d53) },
+  { ULL(0xd1b71758e219652b), ULL(0xd3c36113404ea4a8) },
+  { ULL(0x83126e978d4fdf3b), ULL(0x645a1cac083126e9) },
+  { ULL(0xa3d70a3d70a3d70a), ULL(0x3d70a3d70a3d70a3) },
+  { ULL(0xcccccccccccccccc), ULL(0xcccccccccccccccc) },
+  { ULL(0x8000000000000000), ULL(0x0000000000000000) },
+  { ULL(0xa000000000000000), ULL(0x0000000000000000) },
+  { ULL(0xc800000000000000), ULL(0x0000000000000000) },
+  { ULL(0xfa00000000000000), ULL(0x0000000000000000) },
+  { ULL(0x9c40000000000000), ULL(0x0000000000000000) },
+  { ULL(0xc350000000000000), ULL(0x0000000000000000) },
+  { ULL(0xf424000000000000), ULL(0x0000000000000000) },
+  { ULL(0x9896800000000000), ULL(0x0000000000000000) },
+  { ULL(0xbebc200000000000), ULL(0x0000000000000000) },
+  { ULL(0xee6b280000000000), ULL(0x0000000000000000) },
+  { ULL(0x9502f90000000000), ULL(0x0000000000000000) },
+  { ULL(0xba43b74000000000), ULL(0x0000000000000000) },
+  { ULL(0xe8d4a51000000000), ULL(0x0000000000000000) },
+  { ULL(0x9184e72a00000000), ULL(0x0000000000000000) },
+  { ULL(0xb5e620f480000000), ULL(0x0000000000000000) },
+  { ULL(0xe35fa931a0000000), ULL(0x0000000000000000) },
+  { ULL(0x8e1bc9bf04000000), ULL(0x0000000000000000) },
+  { ULL(0xb1a2bc2ec5000000), ULL(0x0000000000000000) },
+  { ULL(0xde0b6b3a76400000), ULL(0x0000000000000000) },
+  { ULL(0x8ac7230489e80000), ULL(0x0000000000000000) },
+  { ULL(0xad78ebc5ac620000), ULL(0x0000000000000000) },
+  { ULL(0xd8d726b7177a8000), ULL(0x0000000000000000) },
+  { ULL(0x878678326eac9000), ULL(0x0000000000000000) },
+  { ULL(0xa968163f0a57b400), ULL(0x0000000000000000) },
+  { ULL(0xd3c21bcecceda100), ULL(0x0000000000000000) },
+  { ULL(0x84595161401484a0), ULL(0x0000000000000000) },
+  { ULL(0xa56fa5b99019a5c8), ULL(0x0000000000000000) },
+  { ULL(0xcecb8f27f4200f3a), ULL(0x0000000000000000) },
+  { ULL(0x813f3978f8940984), ULL(0x4000000000000000) },
+  { ULL(0xa18f07d736b90be5), ULL(0x5000000000000000) },
+  { ULL(0xc9f2c9cd04674ede), ULL(0xa400000000000000) },
+  { ULL(0xfc6f7c4045812296), ULL(0x4d00000000000000) },
+  { ULL(0x9dc5ada82b70b59d), ULL(0xf020000000000000) },
+  { ULL(0xc5371912364ce305), ULL(0x6c28000000000000) },
+  { ULL(0xf684df56c3e01bc6), ULL(0xc732000000000000) },
+  { ULL(0x9a130b963a6c115c), ULL(0x3c7f400000000000) },
+  { ULL(0xc097ce7bc90715b3), ULL(0x4b9f100000000000) },
+  { ULL(0xf0bdc21abb48db20), ULL(0x1e86d40000000000) },
+  { ULL(0x96769950b50d88f4), ULL(0x1314448000000000) },
+  { ULL(0xbc143fa4e250eb31), ULL(0x17d955a000000000) },
+  { ULL(0xeb194f8e1ae525fd), ULL(0x5dcfab0800000000) },
+  { ULL(0x92efd1b8d0cf37be), ULL(0x5aa1cae500000000) },
+  { ULL(0xb7abc627050305ad), ULL(0xf14a3d9e40000000) },
+  { ULL(0xe596b7b0c643c719), ULL(0x6d9ccd05d0000000) },
+  { ULL(0x8f7e32ce7bea5c6f), ULL(0xe4820023a2000000) },
+  { ULL(0xb35dbf821ae4f38b), ULL(0xdda2802c8a800000) },
+  { ULL(0xe0352f62a19e306e), ULL(0xd50b2037ad200000) },
+  { ULL(0x8c213d9da502de45), ULL(0x4526f422cc340000) },
+  { ULL(0xaf298d050e4395d6), ULL(0x9670b12b7f410000) },
+  { ULL(0xdaf3f04651d47b4c), ULL(0x3c0cdd765f114000) },
+  { ULL(0x88d8762bf324cd0f), ULL(0xa5880a69fb6ac800) },
+  { ULL(0xab0e93b6efee0053), ULL(0x8eea0d047a457a00) },
+  { ULL(0xd5d238a4abe98068), ULL(0x72a4904598d6d880) },
+  { ULL(0x85a36366eb71f041), ULL(0x47a6da2b7f864750) },
+  { ULL(0xa70c3c40a64e6c51), ULL(0x999090b65f67d924) },
+  { ULL(0xd0cf4b50cfe20765), ULL(0xfff4b4e3f741cf6d) },
+  { ULL(0x82818f1281ed449f), ULL(0xbff8f10e7a8921a4) },
+  { ULL(0xa321f2d7226895c7), ULL(0xaff72d52192b6a0d) },
+  { ULL(0xcbea6f8ceb02bb39), ULL(0x9bf4f8a69f764490) },
+  { ULL(0xfee50b7025c36a08), ULL(0x02f236d04753d5b4) },
+  { ULL(0x9f4f2726179a2245), ULL(0x01d762422c946590) },
+  { ULL(0xc722f0ef9d80aad6), ULL(0x424d3ad2b7b97ef5) },
+  { ULL(0xf8ebad2b84e0d58b), ULL(0xd2e0898765a7deb2) },
+  { ULL(0x9b934c3b330c8577), ULL(0x63cc55f49f88eb2f) },
+  { ULL(0xc2781f49ffcfa6d5), ULL(0x3cbf6b71c76b25fb) },
+  { ULL(0xf316271c7fc3908a), ULL(0x8bef464e3945ef7a) },
+  { ULL(0x97edd871cfda3a56), ULL(0x97758bf0e3cbb5ac) },
+  { ULL(0xbde94e8e43d0c8ec), ULL(0x3d52eeed1cbea317) },
+  { ULL(0xed63a231d4c4fb27), ULL(0x4ca7aaa863ee4bdd) },
+  { ULL(0x945e455f24fb1cf8), ULL(0x8fe8caa93e74ef6a) },
+  { ULL(0xb975d6b6ee39e436), ULL(0xb3e2fd538e122b44) },
+  { ULL(0xe7d34c64a9c85d44), ULL(0x60dbbca87196b616) },
+  { ULL(0x90e40fbeea1d3a4a), ULL(0xbc8955e946fe31cd) },
+  { ULL(0xb51d13aea4a488dd), ULL(0x6babab6398bdbe41) },
+  { ULL(0xe264589a4dcdab14), ULL(0xc696963c7eed2dd1) },
+  { ULL(0x8d7eb76070a08aec), ULL(0xfc1e1de5cf543ca2) },
+  { ULL(0xb0de65388cc8ada8), ULL(0x3b25a55f43294bcb) },
+  { ULL(0xdd15fe86affad912), ULL(0x49ef0eb713f39ebe) },
+  { ULL(0x8a2dbf142dfcc7ab), ULL(0x6e3569326c784337) },
+  { ULL(0xacb92ed9397bf996), ULL(0x49c2c37f07965404) },
+  { ULL(0xd7e77a8f87daf7fb), ULL(0xdc33745ec97be906) },
+  { ULL(0x86f0ac99b4e8dafd), ULL(0x69a028bb3ded71a3) },
+  { ULL(0xa8acd7c0222311bc), ULL(0xc40832ea0d68ce0c) },
+  { ULL(0xd2d80db02aabd62b), ULL(0xf50a3fa490c30190) },
+  { ULL(0x83c7088e1aab65db), ULL(0x792667c6da79e0fa) },
+  { ULL(0xa4b8cab1a1563f52), ULL(0x577001b891185938) },
+  { ULL(0xcde6fd5e09abcf26), ULL(0xed4c0226b55e6f86) },
+  { ULL(0x80b05e5ac60b6178), ULL(0x544f8158315b05b4) },
+  { ULL(0xa0dc75f1778e39d6), ULL(0x696361ae3db1c721) },
+  { ULL(0xc913936dd571c84c), ULL(0x03bc3a19cd1e38e9) },
+  { ULL(0xfb5878494ace3a5f), ULL(0x04ab48a04065c723) },
+  { ULL(0x9d174b2dcec0e47b), ULL(0x62eb0d64283f9c76) },
+  { ULL(0xc45d1df942711d9a), ULL(0x3ba5d0bd324f8394) },
+  { ULL(0xf5746577930d6500), ULL(0xca8f44ec7ee36479) },
+  { ULL(0x9968bf6abbe85f20), ULL(0x7e998b13cf4e1ecb) },
+  { ULL(0xbfc2ef456ae276e8), ULL(0x9e3fedd8c321a67e) },
+  { ULL(0xefb3ab16c59b14a2), ULL(0xc5cfe94ef3ea101e) },
+  { ULL(0x95d04aee3b80ece5), ULL(0xbba1f1d158724a12) },
+  { ULL(0xbb445da9ca61281f), ULL(0x2a8a6e45ae8edc97) },
+  { ULL(0xea1575143cf97226), ULL(0xf52d09d71a3293bd) },
+  { ULL(0x924d692ca61be758), ULL(0x593c2626705f9c56) },
+  { ULL(0xb6e0c377cfa2e12e), ULL(0x6f8b2fb00c77836c) },
+  { ULL(0xe498f455c38b997a), ULL(0x0b6dfb9c0f956447) },
+  { ULL(0x8edf98b59a373fec), ULL(0x4724bd4189bd5eac) },
+  { ULL(0xb2977ee300c50fe7), ULL(0x58edec91ec2cb657) },
+  { ULL(0xdf3d5e9bc0f653e1), ULL(0x2f2967b66737e3ed) },
+  { ULL(0x8b865b215899f46c), ULL(0xbd79e0d20082ee74) },
+  { ULL(0xae67f1e9aec07187), ULL(0xecd8590680a3aa11) },
+  { ULL(0xda01ee641a708de9), ULL(0xe80e6f4820cc9495) },
+  { ULL(0x884134fe908658b2), ULL(0x3109058d147fdcdd) },
+  { ULL(0xaa51823e34a7eede), ULL(0xbd4b46f0599fd415) },
+  { ULL(0xd4e5e2cdc1d1ea96), ULL(0x6c9e18ac7007c91a) },
+  { ULL(0x850fadc09923329e), ULL(0x03e2cf6bc604ddb0) },
+  { ULL(0xa6539930bf6bff45), ULL(0x84db8346b786151c) },
+  { ULL(0xcfe87f7cef46ff16), ULL(0xe612641865679a63) },
+  { ULL(0x81f14fae158c5f6e), ULL(0x4fcb7e8f3f60c07e) },
+  { ULL(0xa26da3999aef7749), ULL(0xe3be5e330f38f09d) },
+  { ULL(0xcb090c8001ab551c), ULL(0x5cadf5bfd3072cc5) },
+  { ULL(0xfdcb4fa002162a63), ULL(0x73d9732fc7c8f7f6) },
+  { ULL(0x9e9f11c4014dda7e), ULL(0x2867e7fddcdd9afa) },
+  { ULL(0xc646d63501a1511d), ULL(0xb281e1fd541501b8) },
+  { ULL(0xf7d88bc24209a565), ULL(0x1f225a7ca91a4226) },
+  { ULL(0x9ae757596946075f), ULL(0x3375788de9b06958) },
+  { ULL(0xc1a12d2fc3978937), ULL(0x0052d6b1641c83ae) },
+  { ULL(0xf209787bb47d6b84), ULL(0xc0678c5dbd23a49a) },
+  { ULL(0x9745eb4d50ce6332), ULL(0xf840b7ba963646e0) },
+  { ULL(0xbd176620a501fbff), ULL(0xb650e5a93bc3d898) },
+  { ULL(0xec5d3fa8ce427aff), ULL(0xa3e51f138ab4cebe) },
+  { ULL(0x93ba47c980e98cdf), ULL(0xc66f336c36b10137) },
+  { ULL(0xb8a8d9bbe123f017), ULL(0xb80b0047445d4184) },
+  { ULL(0xe6d3102ad96cec1d), ULL(0xa60dc059157491e5) },
+  { ULL(0x9043ea1ac7e41392), ULL(0x87c89837ad68db2f) },
+  { ULL(0xb454e4a179dd1877), ULL(0x29babe4598c311fb) },
+  { ULL(0xe16a1dc9d8545e94), ULL(0xf4296dd6fef3d67a) },
+  { ULL(0x8ce2529e2734bb1d), ULL(0x1899e4a65f58660c) },
+  { ULL(0xb01ae745b101e9e4), ULL(0x5ec05dcff72e7f8f) },
+  { ULL(0xdc21a1171d42645d), ULL(0x76707543f4fa1f73) },
+  { ULL(0x899504ae72497eba), ULL(0x6a06494a791c53a8) },
+  { ULL(0xabfa45da0edbde69), ULL(0x0487db9d17636892) },
+  { ULL(0xd6f8d7509292d603), ULL(0x45a9d2845d3c42b6) },
+  { ULL(0x865b86925b9bc5c2), ULL(0x0b8a2392ba45a9b2) },
+  { ULL(0xa7f26836f282b732), ULL(0x8e6cac7768d7141e) },
+  { ULL(0xd1ef0244af2364ff), ULL(0x3207d795430cd926) },
+  { ULL(0x8335616aed761f1f), ULL(0x7f44e6bd49e807b8) },
+  { ULL(0xa402b9c5a8d3a6e7), ULL(0x5f16206c9c6209a6) },
+  { ULL(0xcd036837130890a1), ULL(0x36dba887c37a8c0f) },
+  { ULL(0x802221226be55a64), ULL(0xc2494954da2c9789) },
+  { ULL(0xa02aa96b06deb0fd), ULL(0xf2db9baa10b7bd6c) },
+  { ULL(0xc83553c5c8965d3d), ULL(0x6f92829494e5acc7) },
+  { ULL(0xfa42a8b73abbf48c), ULL(0xcb772339ba1f17f9) },
+  { ULL(0x9c69a97284b578d7), ULL(0xff2a760414536efb) },
+  { ULL(0xc38413cf25e2d70d), ULL(0xfef5138519684aba) },
+  { ULL(0xf46518c2ef5b8cd1), ULL(0x7eb258665fc25d69) },
+  { ULL(0x98bf2f79d5993802), ULL(0xef2f773ffbd97a61) },
+  { ULL(0xbeeefb584aff8603), ULL(0xaafb550ffacfd8fa) },
+  { ULL(0xeeaaba2e5dbf6784), ULL(0x95ba2a53f983cf38) },
+  { ULL(0x952ab45cfa97a0b2), ULL(0xdd945a747bf26183) },
+  { ULL(0xba756174393d88df), ULL(0x94f971119aeef9e4) },
+  { ULL(0xe912b9d1478ceb17), ULL(0x7a37cd5601aab85d) },
+  { ULL(0x91abb422ccb812ee), ULL(0xac62e055c10ab33a) },
+  { ULL(0xb616a12b7fe617aa), ULL(0x577b986b314d6009) },
+  { ULL(0xe39c49765fdf9d94), ULL(0xed5a7e85fda0b80b) },
+  { ULL(0x8e41ade9fbebc27d), ULL(0x14588f13be847307) },
+  { ULL(0xb1d219647ae6b31c), ULL(0x596eb2d8ae258fc8) },
+  { ULL(0xde469fbd99a05fe3), ULL(0x6fca5f8ed9aef3bb) },
+  { ULL(0x8aec23d680043bee), ULL(0x25de7bb9480d5854) },
+  { ULL(0xada72ccc20054ae9), ULL(0xaf561aa79a10ae6a) },
+  { ULL(0xd910f7ff28069da4), ULL(0x1b2ba1518094da04) },
+  { ULL(0x87aa9aff79042286), ULL(0x90fb44d2f05d0842) },
+  { ULL(0xa99541bf57452b28), ULL(0x353a1607ac744a53) },
+  { ULL(0xd3fa922f2d1675f2), ULL(0x42889b8997915ce8) },
+  { ULL(0x847c9b5d7c2e09b7), ULL(0x69956135febada11) },
+  { ULL(0xa59bc234db398c25), ULL(0x43fab9837e699095) },
+  { ULL(0xcf02b2c21207ef2e), ULL(0x94f967e45e03f4bb) },
+  { ULL(0x8161afb94b44f57d), ULL(0x1d1be0eebac278f5) },
+  { ULL(0xa1ba1ba79e1632dc), ULL(0x6462d92a69731732) },
+  { ULL(0xca28a291859bbf93), ULL(0x7d7b8f7503cfdcfe) },
+  { ULL(0xfcb2cb35e702af78), ULL(0x5cda735244c3d43e) },
+  { ULL(0x9defbf01b061adab), ULL(0x3a0888136afa64a7) },
+  { ULL(0xc56baec21c7a1916), ULL(0x088aaa1845b8fdd0) },
+  { ULL(0xf6c69a72a3989f5b), ULL(0x8aad549e57273d45) },
+  { ULL(0x9a3c2087a63f6399), ULL(0x36ac54e2f678864b) },
+  { ULL(0xc0cb28a98fcf3c7f), ULL(0x84576a1bb416a7dd) },
+  { ULL(0xf0fdf2d3f3c30b9f), ULL(0x656d44a2a11c51d5) },
+  { ULL(0x969eb7c47859e743), ULL(0x9f644ae5a4b1b325) },
+  { ULL(0xbc4665b596706114), ULL(0x873d5d9f0dde1fee) },
+  { ULL(0xeb57ff22fc0c7959), ULL(0xa90cb506d155a7ea) },
+  { ULL(0x9316ff75dd87cbd8), ULL(0x09a7f12442d588f2) },
+  { ULL(0xb7dcbf5354e9bece), ULL(0x0c11ed6d538aeb2f) },
+  { ULL(0xe5d3ef282a242e81), ULL(0x8f1668c8a86da5fa) },
+  { ULL(0x8fa475791a569d10), ULL(0xf96e017d694487bc) },
+  { ULL(0xb38d92d760ec4455), ULL(0x37c981dcc395a9ac) },
+  { ULL(0xe070f78d3927556a), ULL(0x85bbe253f47b1417) },
+  { ULL(0x8c469ab843b89562), ULL(0x93956d7478ccec8e) },
+  { ULL(0xaf58416654a6babb), ULL(0x387ac8d1970027b2) },
+  { ULL(0xdb2e51bfe9d0696a), ULL(0x06997b05fcc0319e) },
+  { ULL(0x88fcf317f22241e2), ULL(0x441fece3bdf81f03) },
+  { ULL(0xab3c2fddeeaad25a), ULL(0xd527e81cad7626c3) },
+  { ULL(0xd60b3bd56a5586f1), ULL(0x8a71e223d8d3b074) },
+  { ULL(0x85c7056562757456), ULL(0xf6872d5667844e49) },
+  { ULL(0xa738c6bebb12d16c), ULL(0xb428f8ac016561db) },
+  { ULL(0xd106f86e69d785c7), ULL(0xe13336d701beba52) },
+  { ULL(0x82a45b450226b39c), ULL(0xecc0024661173473) },
+  { ULL(0xa34d721642b06084), ULL(0x27f002d7f95d0190) },
+  { ULL(0xcc20ce9bd35c78a5), ULL(0x31ec038df7b441f4) },
+  { ULL(0xff290242c83396ce), ULL(0x7e67047175a15271) },
+  { ULL(0x9f79a169bd203e41), ULL(0x0f0062c6e984d386) },
+  { ULL(0xc75809c42c684dd1), ULL(0x52c07b78a3e60868) },
+  { ULL(0xf92e0c3537826145), ULL(0xa7709a56ccdf8a82) },
+  { ULL(0x9bbcc7a142b17ccb), ULL(0x88a66076400bb691) },
+  { ULL(0xc2abf989935ddbfe), ULL(0x6acff893d00ea435) },
+  { ULL(0xf356f7ebf83552fe), ULL(0x0583f6b8c4124d43) },
+  { ULL(0x98165af37b2153de), ULL(0xc3727a337a8b704a) },
+  { ULL(0xbe1bf1b059e9a8d6), ULL(0x744f18c0592e4c5c) },
+  { ULL(0xeda2ee1c7064130c), ULL(0x1162def06f79df73) },
+  { ULL(0x9485d4d1c63e8be7), ULL(0x8addcb5645ac2ba8) },
+  { ULL(0xb9a74a0637ce2ee1), ULL(0x6d953e2bd7173692) },
+  { ULL(0xe8111c87c5c1ba99), ULL(0xc8fa8db6ccdd0437) },
+  { ULL(0x910ab1d4db9914a0), ULL(0x1d9c9892400a22a2) },
+  { ULL(0xb54d5e4a127f59c8), ULL(0x2503beb6d00cab4b) },
+  { ULL(0xe2a0b5dc971f303a), ULL(0x2e44ae64840fd61d) },
+  { ULL(0x8da471a9de737e24), ULL(0x5ceaecfed289e5d2) },
+  { ULL(0xb10d8e1456105dad), ULL(0x7425a83e872c5f47) },
+  { ULL(0xdd50f1996b947518), ULL(0xd12f124e28f77719) },
+  { ULL(0x8a5296ffe33cc92f), ULL(0x82bd6b70d99aaa6f) },
+  { ULL(0xace73cbfdc0bfb7b), ULL(0x636cc64d1001550b) },
+  { ULL(0xd8210befd30efa5a), ULL(0x3c47f7e05401aa4e) },
+  { ULL(0x8714a775e3e95c78), ULL(0x65acfaec34810a71) },
+  { ULL(0xa8d9d1535ce3b396), ULL(0x7f1839a741a14d0d) },
+  { ULL(0xd31045a8341ca07c), ULL(0x1ede48111209a050) },
+  { ULL(0x83ea2b892091e44d), ULL(0x934aed0aab460432) },
+  { ULL(0xa4e4b66b68b65d60), ULL(0xf81da84d5617853f) },
+  { ULL(0xce1de40642e3f4b9), ULL(0x36251260ab9d668e) },
+  { ULL(0x80d2ae83e9ce78f3), ULL(0xc1d72b7c6b426019) },
+  { ULL(0xa1075a24e4421730), ULL(0xb24cf65b8612f81f) },
+  { ULL(0xc94930ae1d529cfc), ULL(0xdee033f26797b627) },
+  { ULL(0xfb9b7cd9a4a7443c), ULL(0x169840ef017da3b1) },
+  { ULL(0x9d412e0806e88aa5), ULL(0x8e1f289560ee864e) },
+  { ULL(0xc491798a08a2ad4e), ULL(0xf1a6f2bab92a27e2) },
+  { ULL(0xf5b5d7ec8acb58a2), ULL(0xae10af696774b1db) },
+  { ULL(0x9991a6f3d6bf1765), ULL(0xacca6da1e0a8ef29) },
+  { ULL(0xbff610b0cc6edd3f), ULL(0x17fd090a58d32af3) },
+  { ULL(0xeff394dcff8a948e), ULL(0xddfc4b4cef07f5b0) },
+  { ULL(0x95f83d0a1fb69cd9), ULL(0x4abdaf101564f98e) },
+  { ULL(0xbb764c4ca7a4440f), ULL(0x9d6d1ad41abe37f1) },
+  { ULL(0xea53df5fd18d5513), ULL(0x84c86189216dc5ed) },
+  { ULL(0x92746b9be2f8552c), ULL(0x32fd3cf5b4e49bb4) },
+  { ULL(0xb7118682dbb66a77), ULL(0x3fbc8c33221dc2a1) },
+  { ULL(0xe4d5e82392a40515), ULL(0x0fabaf3feaa5334a) },
+  { ULL(0x8f05b1163ba6832d), ULL(0x29cb4d87f2a7400e) },
+  { ULL(0xb2c71d5bca9023f8), ULL(0x743e20e9ef511012) },
+  { ULL(0xdf78e4b2bd342cf6), ULL(0x914da9246b255416) },
+  { ULL(0x8bab8eefb6409c1a), ULL(0x1ad089b6c2f7548e) },
+  { ULL(0xae9672aba3d0c320), ULL(0xa184ac2473b529b1) },
+  { ULL(0xda3c0f568cc4f3e8), ULL(0xc9e5d72d90a2741e) },
+  { ULL(0x8865899617fb1871), ULL(0x7e2fa67c7a658892) },
+  { ULL(0xaa7eebfb9df9de8d), ULL(0xddbb901b98feeab7) },
+  { ULL(0xd51ea6fa85785631), ULL(0x552a74227f3ea565) },
+  { ULL(0x8533285c936b35de), ULL(0xd53a88958f87275f) },
+  { ULL(0xa67ff273b8460356), ULL(0x8a892abaf368f137) },
+  { ULL(0xd01fef10a657842c), ULL(0x2d2b7569b0432d85) },
+  { ULL(0x8213f56a67f6b29b), ULL(0x9c3b29620e29fc73) },
+  { ULL(0xa298f2c501f45f42), ULL(0x8349f3ba91b47b8f) },
+  { ULL(0xcb3f2f7642717713), ULL(0x241c70a936219a73) },
+  { ULL(0xfe0efb53d30dd4d7), ULL(0xed238cd383aa0110) },
+  { ULL(0x9ec95d1463e8a506), ULL(0xf4363804324a40aa) },
+  { ULL(0xc67bb4597ce2ce48), ULL(0xb143c6053edcd0d5) },
+  { ULL(0xf81aa16fdc1b81da), ULL(0xdd94b7868e94050a) },
+  { ULL(0x9b10a4e5e9913128), ULL(0xca7cf2b4191c8326) },
+  { ULL(0xc1d4ce1f63f57d72), ULL(0xfd1c2f611f63a3f0) },
+  { ULL(0xf24a01a73cf2dccf), ULL(0xbc633b39673c8cec) },
+  { ULL(0x976e41088617ca01), ULL(0xd5be0503e085d813) },
+  { ULL(0xbd49d14aa79dbc82), ULL(0x4b2d8644d8a74e18) },
+  { ULL(0xec9c459d51852ba2), ULL(0xddf8e7d60ed1219e) },
+  { ULL(0x93e1ab8252f33b45), ULL(0xcabb90e5c942b503) },
+  { ULL(0xb8da1662e7b00a17), ULL(0x3d6a751f3b936243) },
+  { ULL(0xe7109bfba19c0c9d), ULL(0x0cc512670a783ad4) },
+  { ULL(0x906a617d450187e2), ULL(0x27fb2b80668b24c5) },
+  { ULL(0xb484f9dc9641e9da), ULL(0xb1f9f660802dedf6) },
+  { ULL(0xe1a63853bbd26451), ULL(0x5e7873f8a0396973) },
+  { ULL(0x8d07e33455637eb2), ULL(0xdb0b487b6423e1e8) },
+  { ULL(0xb049dc016abc5e5f), ULL(0x91ce1a9a3d2cda62) },
+  { ULL(0xdc5c5301c56b75f7), ULL(0x7641a140cc7810fb) },
+  { ULL(0x89b9b3e11b6329ba), ULL(0xa9e904c87fcb0a9d) },
+  { ULL(0xac2820d9623bf429), ULL(0x546345fa9fbdcd44) },
+  { ULL(0xd732290fbacaf133), ULL(0xa97c177947ad4095) },
+  { ULL(0x867f59a9d4bed6c0), ULL(0x49ed8eabcccc485d) },
+  { ULL(0xa81f301449ee8c70), ULL(0x5c68f256bfff5a74) },
+  { ULL(0xd226fc195c6a2f8c), ULL(0x73832eec6fff3111) },
+  { ULL(0x83585d8fd9c25db7), ULL(0xc831fd53c5ff7eab) },
+  { ULL(0xa42e74f3d032f525), ULL(0xba3e7ca8b77f5e55) },
+  { ULL(0xcd3a1230c43fb26f), ULL(0x28ce1bd2e55f35eb) },
+  { ULL(0x80444b5e7aa7cf85), ULL(0x7980d163cf5b81b3) },
+  { ULL(0xa0555e361951c366), ULL(0xd7e105bcc332621f) },
+  { ULL(0xc86ab5c39fa63440), ULL(0x8dd9472bf3fefaa7) },
+  { ULL(0xfa856334878fc150), ULL(0xb14f98f6f0feb951) },
+  { ULL(0x9c935e00d4b9d8d2), ULL(0x6ed1bf9a569f33d3) },
+  { ULL(0xc3b8358109e84f07), ULL(0x0a862f80ec4700c8) },
+  { ULL(0xf4a642e14c6262c8), ULL(0xcd27bb612758c0fa) },
+  { ULL(0x98e7e9cccfbd7dbd), ULL(0x8038d51cb897789c) },
+  { ULL(0xbf21e44003acdd2c), ULL(0xe0470a63e6bd56c3) },
+  { ULL(0xeeea5d5004981478), ULL(0x1858ccfce06cac74) },
+  { ULL(0x95527a5202df0ccb), ULL(0x0f37801e0c43ebc8) },
+  { ULL(0xbaa718e68396cffd), ULL(0xd30560258f54e6ba) },
+  { ULL(0xe950df20247c83fd), ULL(0x47c6b82ef32a2069) },
+  { ULL(0x91d28b7416cdd27e), ULL(0x4cdc331d57fa5441) },
+  { ULL(0xb6472e511c81471d), ULL(0xe0133fe4adf8e952) },
+  { ULL(0xe3d8f9e563a198e5), ULL(0x58180fddd97723a6) },
+  { ULL(0x8e679c2f5e44ff8f), ULL(0x570f09eaa7ea7648) }
+};
+
+int
+fast_strtod(const char *s, const char *e, double *f)
+{ uint64_t man = 0;
+  int digits = 0;
+  int exp10 = 0;
+  int neg = FALSE;
+  uint64_t hi, lo;
+  uint64_t mantissa;
+  int shift, msb;
+  int64_t bexp;
+  dbl_bits u;
+
+  if ( s < e && (*s == '-' || *s == '+') )
+    neg = (*s++ == '-');
+  for( ; s < e && *s >= '0' && *s <= '9'; s++ )
+  { if ( man || *s != '0' )
+    { if ( ++digits > 19 )
+	return FALSE;
+      man = man*10 + (*s-'0');
+    }
+  }
+  if ( s < e && *s == '.' )
+  { for(s++; s < e && *s >= '0' && *s <= '9'; s++ )
+    { if ( man || *s != '0' )
+      { if ( ++digits > 19 )
+	  return FALSE;
+	man = man*10 + (*s-'0');
+      }
+      exp10--;
+    }
+  }
+  if ( s < e && (*s == 'e' || *s == 'E') )
+  { int eneg = FALSE;
+    int ev = 0;
+
+    s++;
+    if ( s < e && (*s == '-' || *s == '+') )
+      eneg = (*s++ == '-');
+    for( ; s < e && *s >= '0' && *s <= '9'; s++ )
+    { if ( ev > 100000 )
+	return FALSE;
+      ev = ev*10 + (*s-'0');
+    }
+    exp10 += eneg ? -ev : ev;
+  }
+  if ( s != e )
+    return FALSE;
+
+  if ( man == 0 )
+  { *f = neg ? -0.0 : 0.0;
+    return TRUE;
+  }
+  if ( exp10 < POW10_MIN || exp10 > POW10_MAX )
+    return FALSE;
+
+  shift = 63 - MSB64(man);
+  man <<= shift;
+  bexp = (((int64_t)217706*exp10)>>16) + 64 + 1023 - shift;
+
+  mul_64x64(man, pow10_128[exp10-POW10_MIN][0], &hi, &lo);
+  if ( (hi&0x1ff) == 0x1ff && lo+man < man )
+  { uint64_t yhi, ylo;			/* use the lower 64 bits of 10^e */
+
+    mul_64x64(man, pow10_128[exp10-POW10_MIN][1], &yhi, &ylo);
+    if ( lo+yhi < lo )
+      hi++;
+    lo += yhi;
+    if ( (hi&0x1ff) == 0x1ff && lo+1 == 0 && ylo+man < man )
+      return FALSE;
+  }
+
+  msb = (int)(hi>>63);
+  mantissa = hi >> (msb+9);
+  bexp -= 1^msb;
+  if ( lo == 0 && (hi&0x1ff) == 0 && (mantissa&3) == 1 )
+    return FALSE;			/* halfway */
+
+  mantissa += mantissa&1;		/* round to 53 bits */
+  mantissa >>= 1;
+  if ( mantissa >> 53 )
+  { mantissa >>= 1;
+    bexp++;
+  }
+  if ( bexp <= 0 || bexp >= 0x7ff )	/* subnormal or overflow */
+    return FALSE;
+
+  u.i = ((uint64_t)bexp<<52) | (mantissa & ((ULL(1)<<52)-1));
+  if ( neg )
+    u.i |= ULL(1)<<63;
+  *f = u.d;
+
+  return TRUE;
+}
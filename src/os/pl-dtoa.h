@@ -46,4 +46,9 @@ COMMON(char *)	dtoa(double dd, int mode, int ndigits,
 COMMON(void)	freedtoa(char *s);
 double		strtod(const char *in, char **end);
 
+#define FAST_DTOA_BUFSIZE 32
+COMMON(char *)	fast_dtoa(double d, char *buf,
+			  int *decpt, int *sign, char **rve);
+COMMON(int)	fast_strtod(const char *s, const char *e, double *f);
+
 #endif /*PL_DTOA_H_INCLUDED*/
@@ -158,6 +158,7 @@ typedef struct
   alias *alias_tail;
   atom_t filename;			/* associated filename */
   unsigned flags;
+  struct fastrw_dict *fastrw;		/* fast_write/fast_read dictionary */
 } stream_context;
 
 
@@ -174,6 +175,7 @@ getStreamContext(IOSTREAM *s)
     ctx->alias_head = ctx->alias_tail = NULL;
     ctx->filename = NULL_ATOM;
     ctx->flags = 0;
+    ctx->fastrw = NULL;
     if ( COMPARE_AND_SWAP(&s->context, NULL, ctx) )
       addNewHTable(streamContext, s, ctx);
     else
@@ -189,6 +191,18 @@ getExistingStreamContext(IOSTREAM *s)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+streamFastRWDict() returns the location of  the dictionary used by the
+streaming mode of fast_write/3 and fast_read/2.  See pl-rec.c.  Must be
+called with the stream locked.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+struct fastrw_dict **
+streamFastRWDict(IOSTREAM *s)
+{ return &getStreamContext(s)->fastrw;
+}
+
+
 /* MT: Must be called locked */
 
 static void
@@ -294,6 +308,8 @@ freeStream(IOSTREAM *s)
 	source_line_no = -1;
       }
     }
+    if ( ctx->fastrw )
+      freeFastRWDict(ctx->fastrw);
 
     freeHeap(ctx, sizeof(*ctx));
   }
@@ -1943,6 +1959,17 @@ set_stream(IOSTREAM *s, term_t stream, atom_t aname, term_t a ARG_LD)
     if ( size < 1 )
       return PL_error(NULL, 0, NULL, ERR_DOMAIN, ATOM_not_less_than_one, a);
     Ssetbuffer(s, NULL, size);
+    s->flags &= ~SIO_ADAPTIVE;	/* user wants this size */
+    return TRUE;
+  } else if ( aname == ATOM_adaptive_buffer )
+  { int adaptive;
+
+    if ( !PL_get_bool_ex(a, &adaptive) )
+      return FALSE;
+    if ( adaptive )
+      s->flags |= SIO_ADAPTIVE;
+    else
+      s->flags &= ~SIO_ADAPTIVE;
     return TRUE;
   } else if ( aname == ATOM_eof_action ) /* eof_action(Action) */
   { atom_t action;
@@ -2172,6 +2199,7 @@ static const set_stream_info ss_info[] =
 { SS_INFO(ATOM_alias,		      SS_EITHER),
   SS_INFO(ATOM_buffer,		      SS_BOTH),
   SS_INFO(ATOM_buffer_size,	      SS_BOTH),
+  SS_INFO(ATOM_adaptive_buffer,	      SS_BOTH),
   SS_INFO(ATOM_eof_action,	      SS_READ),
   SS_INFO(ATOM_type,		      SS_BOTH),
   SS_INFO(ATOM_close_on_abort,	      SS_BOTH),
@@ -3676,6 +3704,8 @@ static const opt_spec open4_options[] =
   { ATOM_encoding,	 OPT_ATOM },
   { ATOM_bom,		 OPT_BOOL },
   { ATOM_create,	 OPT_TERM },
+  { ATOM_async,		 OPT_BOOL },
+  { ATOM_mmap,		 OPT_BOOL },
 #ifdef O_LOCALE
   { ATOM_locale,	 OPT_LOCALE },
 #endif
@@ -3742,6 +3772,8 @@ openStream(term_t file, term_t mode, term_t options)
   int    close_on_abort = TRUE;
   int	 bom		= -1;
   term_t create		= 0;
+  int	 async		= FALSE;
+  int	 mapped		= FALSE;
   char   how[16];
   char  *h		= how;
   char *path;
@@ -3752,7 +3784,7 @@ openStream(term_t file, term_t mode, term_t options)
   { if ( !scan_options(options, 0, ATOM_stream_option, open4_options,
 		       &type, &reposition, &alias, &eof_action,
 		       &close_on_abort, &buffer, &lock, &wait,
-		       &encoding, &bom, &create
+		       &encoding, &bom, &create, &async, &mapped
 #ifdef O_LOCALE
 		       , &locale
 #endif
@@ -3819,6 +3851,10 @@ openStream(term_t file, term_t mode, term_t options)
     bom = (mname == ATOM_read ? TRUE : FALSE);
   if ( type == ATOM_binary )
     *h++ = 'b';
+  if ( async )
+    *h++ = 'A';
+  if ( mapped )
+    *h++ = 'M';
 
 					/* File locking */
   if ( lock != ATOM_none )
@@ -4535,6 +4571,28 @@ stream_tty_prop(IOSTREAM *s, term_t prop ARG_LD)
 }
 
 
+static int
+stream_async_prop(IOSTREAM *s, term_t prop ARG_LD)
+{ IGNORE_LD
+
+  if ( Sisasync(s) )
+    return PL_unify_bool_ex(prop, TRUE);
+
+  return FALSE;
+}
+
+
+static int
+stream_mmap_prop(IOSTREAM *s, term_t prop ARG_LD)
+{ IGNORE_LD
+
+  if ( Sismapped(s) )
+    return PL_unify_bool_ex(prop, TRUE);
+
+  return FALSE;
+}
+
+
 static int
 stream_bom_prop(IOSTREAM *s, term_t prop ARG_LD)
 { IGNORE_LD
@@ -4719,6 +4777,8 @@ static const sprop sprop_list [] =
   { FUNCTOR_locale1,	    stream_locale_prop },
 #endif
   { FUNCTOR_bom1,	    stream_bom_prop },
+  { FUNCTOR_async1,	    stream_async_prop },
+  { FUNCTOR_mmap1,	    stream_mmap_prop },
   { FUNCTOR_newline1,	    stream_newline_prop },
   { FUNCTOR_representation_errors1, stream_reperror_prop },
   { FUNCTOR_write_errors1,  stream_writeerror_prop },
@@ -5611,14 +5671,43 @@ PRED_IMPL("$size_stream", 2, size_stream, 0)
 copy_stream_data(+StreamIn, +StreamOut, [Len])
 	Copy all data from StreamIn to StreamOut.  Should be somewhere else,
 	and maybe we need something else to copy resources.
+
+If copying the bytes is the same as  copying the characters, we use
+Scopy(), which copies blocks and uses the kernel to copy between plain
+file descriptors.  Len is in characters, so we can only pass it for
+single-byte encodings.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+static int
+copy_bytes_ok(IOSTREAM *i, IOSTREAM *o, int has_len)
+{ if ( i->encoding != o->encoding || i->tee || o->tee ||
+       (o->flags & SIO_NBUF) )
+    return FALSE;
+  if ( ((i->flags & SIO_TEXT) && i->newline != SIO_NL_POSIX) ||
+       ((o->flags & SIO_TEXT) && o->newline != SIO_NL_POSIX) )
+    return FALSE;
+
+  switch(i->encoding)
+  { case ENC_OCTET:
+    case ENC_ISO_LATIN_1:
+      return TRUE;
+    case ENC_UTF8:
+      return !has_len;
+    default:
+      return FALSE;
+  }
+}
+
+
 static int
 copy_stream_data(term_t in, term_t out, term_t len ARG_LD)
 { IOSTREAM *i, *o;
   int c;
   int count = 0;
+  int64_t n = -1;
 
+  if ( len && !PL_get_int64_ex(len, &n) )
+    return FALSE;
   if ( !getInputStream(in, S_DONTCARE, &i) )
     return FALSE;
   if ( !getOutputStream(out, S_DONTCARE, &o) )
@@ -5626,34 +5715,25 @@ copy_stream_data(term_t in, term_t out, term_t len ARG_LD)
     return FALSE;
   }
 
-  if ( !len )
-  { while ( (c = Sgetcode(i)) != EOF )
-    { if ( (++count % 4096) == 0 && PL_handle_signals() < 0 )
-      { releaseStream(i);
-	releaseStream(o);
-	return FALSE;
-      }
-      if ( Sputcode(c, o) < 0 )
-      { releaseStream(i);
-	return streamStatus(o);
-      }
+  if ( copy_bytes_ok(i, o, len != 0) )
+  { if ( n != 0 )
+      Scopy(i, o, n);			/* errors are on the streams */
+    if ( !streamStatus(o) )
+    { releaseStream(i);
+      return FALSE;
     }
-  } else
-  { int64_t n;
+    return streamStatus(i);
+  }
 
-    if ( !PL_get_int64_ex(len, &n) )
+  while ( (n < 0 || n-- > 0) && (c = Sgetcode(i)) != EOF )
+  { if ( (++count % 4096) == 0 && PL_handle_signals() < 0 )
+    { releaseStream(i);
+      releaseStream(o);
       return FALSE;
-
-    while ( n-- > 0 && (c = Sgetcode(i)) != EOF )
-    { if ( (++count % 4096) == 0 && PL_handle_signals() < 0 )
-      { releaseStream(i);
-	releaseStream(o);
-	return FALSE;
-      }
-      if ( Sputcode(c, o) < 0 )
-      { releaseStream(i);
-	return streamStatus(o);
-      }
+    }
+    if ( Sputcode(c, o) < 0 )
+    { releaseStream(i);
+      return streamStatus(o);
     }
   }
 
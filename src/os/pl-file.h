@@ -99,6 +99,7 @@ COMMON(int)		pop_input_context(void);
 COMMON(int)		stream_encoding_options(atom_t type, atom_t encoding,
 						int *bom, IOENC *enc);
 COMMON(int)		file_name_is_iri(const char *path);
+COMMON(struct fastrw_dict **) streamFastRWDict(IOSTREAM *s);
 COMMON(int)		iri_hook(const char *url, iri_op op, ...);
 
 #endif /*PL_FILE_H_INCLUDED*/
@@ -144,10 +144,8 @@ outstring(format_state *state, const char *s, size_t len)
   { addMultipleBuffer(&state->buffer, s, len, char);
     state->buffered += len;
   } else
-  { for(q=s; q < e; q++)
-    { if ( Sputcode(*q&0xff, state->out) < 0 )
-	return FALSE;
-    }
+  { if ( Sfputsn(s, len, state->out) < 0 )
+      return FALSE;
   }
 
   for(q=s; q < e; q++)
@@ -161,6 +159,20 @@ static WUNUSED int
 oututf8(format_state *state, const char *s, size_t len)
 { const char *e = &s[len];
 
+  if ( !state->pending_rubber )
+  { if ( Swrite_text(s, len, state->out) < 0 )
+      return FALSE;
+
+    while(s<e)
+    { int chr;
+
+      s = utf8_get_char(s, &chr);
+      state->column = update_column(state->column, chr);
+    }
+
+    return TRUE;
+  }
+
   while(s<e)
   { int chr;
 
@@ -205,9 +217,46 @@ outtext(format_state *state, PL_chars_t *txt)
 
 #define format_predicates (GD->format.predicates)
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+A format specification is compiled  into   a  fmt_program: a sequence of
+directives with their numeric argument and  colon modifier and the text
+between the directives as UTF-8.  Compiled  programs for atoms are kept
+in a per-thread direct-mapped cache  of FMT_CACHE_SIZE slots indexed by
+the atom, such that formatting with a  constant format only needs to
+process the arguments.  The atoms in the cache are locked.  A new format
+replaces the program in its slot and unlocks the atom of that program,
+unless the program is running (format/2 may  be called recursively from
+a ~p or user-defined directive), in which case the new format is not
+cached.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define FMT_TEXT	(-1)		/* directive for literal text */
+#define FMT_STAR	(-2)		/* argument is ~* */
+#define FMT_CACHE_SIZE	256		/* # slots in the format cache */
+
+typedef struct fmt_directive
+{ int		code;			/* directive character or FMT_TEXT */
+  int		arg;			/* numeric argument */
+  int		colon;			/* used colon modifier */
+  size_t	offset;			/* FMT_TEXT: offset in text */
+  size_t	length;			/* FMT_TEXT: length in bytes */
+  int		ascii;			/* FMT_TEXT: only printable ASCII */
+} fmt_directive;
+
+typedef struct fmt_program
+{ size_t	size;			/* allocated size */
+  atom_t	atom;			/* cached: format atom */
+  int		busy;			/* cached: # running do_format() */
+  size_t	count;			/* # directives */
+  fmt_directive *directives;		/* the directives */
+  char	       *text;			/* UTF-8 literal text */
+} fmt_program;
+
 static int	update_column(int, Char);
-static bool	do_format(IOSTREAM *fd, PL_chars_t *fmt,
+static bool	do_format(IOSTREAM *fd, fmt_program *prog,
 			  int ac, term_t av, Module m);
+static fmt_program *compile_format(PL_chars_t *fmt);
+static void	free_format(fmt_program *prog);
 static void	distribute_rubber(struct rubber *, int, int);
 static int	emit_rubber(format_state *state);
 
@@ -286,6 +335,73 @@ pl_current_format_predicate(term_t chr, term_t descr, control_t h)
 }
 
 
+/* cached_format() returns the cached program for `a` or NULL.
+*/
+
+static fmt_program *
+cached_format(atom_t a ARG_LD)
+{ fmt_program *prog;
+
+  if ( LD->format.cache &&
+       (prog = LD->format.cache[indexAtom(a)%FMT_CACHE_SIZE]) &&
+       prog->atom == a )
+    return prog;
+
+  return NULL;
+}
+
+
+/* cache_format() adds prog as the compiled program for `a`, replacing
+   the program in its slot.  Returns FALSE if that program is running.
+*/
+
+static int
+cache_format(atom_t a, fmt_program *prog ARG_LD)
+{ fmt_program **slot;
+
+  if ( !LD->format.cache )
+  { size_t bytes = FMT_CACHE_SIZE*sizeof(fmt_program*);
+
+    if ( !(LD->format.cache = malloc(bytes)) )
+      return FALSE;
+    memset(LD->format.cache, 0, bytes);
+  }
+
+  slot = &LD->format.cache[indexAtom(a)%FMT_CACHE_SIZE];
+  if ( *slot )
+  { if ( (*slot)->busy )
+      return FALSE;
+    PL_unregister_atom((*slot)->atom);
+    free_format(*slot);
+  }
+
+  PL_register_atom(a);
+  prog->atom = a;
+  *slot = prog;
+
+  return TRUE;
+}
+
+
+void
+freeFormatCache(PL_local_data_t *ld)
+{ fmt_program **cache;
+
+  if ( (cache = ld->format.cache) )
+  { int i;
+
+    ld->format.cache = NULL;
+    for(i=0; i<FMT_CACHE_SIZE; i++)
+    { if ( cache[i] )
+      { PL_unregister_atom(cache[i]->atom);
+	free_format(cache[i]);
+      }
+    }
+    free(cache);
+  }
+}
+
+
 static word
 format_impl(IOSTREAM *out, term_t format, term_t Args, Module m)
 { GET_LD
@@ -293,10 +409,24 @@ format_impl(IOSTREAM *out, term_t format, term_t Args, Module m)
   int argc = 0;
   term_t args = PL_copy_term_ref(Args);
   int rval;
-  PL_chars_t fmt;
+  atom_t a = 0;
+  fmt_program *prog;
+  int cached = FALSE;
 
-  if ( !PL_get_text(format, &fmt, CVT_ALL|BUF_RING) )
-    return PL_error("format", 3, NULL, ERR_TYPE, ATOM_text, format);
+  if ( PL_get_atom(format, &a) && (prog = cached_format(a PASS_LD)) )
+  { cached = TRUE;
+  } else
+  { PL_chars_t fmt;
+
+    if ( !PL_get_text(format, &fmt, CVT_ALL|BUF_RING) )
+      return PL_error("format", 3, NULL, ERR_TYPE, ATOM_text, format);
+    prog = compile_format(&fmt);
+    PL_free_text(&fmt);
+    if ( !prog )
+      return FALSE;
+    if ( a )
+      cached = cache_format(a, prog PASS_LD);
+  }
 
   if ( (argc = (int)lengthList(args, FALSE)) >= 0 )
   { term_t head = PL_new_term_ref();
@@ -312,19 +442,13 @@ format_impl(IOSTREAM *out, term_t format, term_t Args, Module m)
     PL_put_term(argv, args);
   }
 
-  switch(fmt.storage)			/* format can do call-back! */
-  { case PL_CHARS_RING:
-    case PL_CHARS_STACK:
-      PL_save_text(&fmt, BUF_MALLOC);
-      break;
-    default:
-      break;
-  }
-
   Slock(out);
-  rval = do_format(out, &fmt, argc, argv, m);
+  prog->busy++;
+  rval = do_format(out, prog, argc, argv, m);
+  prog->busy--;
   Sunlock(out);
-  PL_free_text(&fmt);
+  if ( !cached )
+    free_format(prog);
 
   return rval;
 }
@@ -372,16 +496,135 @@ get_chr_from_text(const PL_chars_t *t, int index)
 }
 
 
+static inline int
+fmt_chr(const PL_chars_t *t, size_t index)
+{ return index < t->length ? get_chr_from_text(t, (int)index) : 0;
+}
+
+
+		/********************************
+		*          COMPILATION		*
+		********************************/
+
+static void
+add_text(Buffer dirs, Buffer text, int c)
+{ fmt_directive *d = topBuffer(dirs, fmt_directive) - 1;
+  char buf[8];
+  char *e;
+
+  if ( entriesBuffer(dirs, fmt_directive) == 0 || d->code != FMT_TEXT )
+  { fmt_directive n = {FMT_TEXT, DEFAULT, FALSE, entriesBuffer(text, char), 0, TRUE};
+
+    addBuffer(dirs, n, fmt_directive);
+    d = topBuffer(dirs, fmt_directive) - 1;
+  }
+
+  if ( !(c >= ' ' && c < 127) )
+    d->ascii = FALSE;
+  e = utf8_put_char(buf, c);
+  addMultipleBuffer(text, buf, e-buf, char);
+  d->length += e-buf;
+}
+
+
+static fmt_program *
+compile_format(PL_chars_t *fmt)
+{ tmp_buffer dirs, text;
+  fmt_program *prog = NULL;
+  size_t here = 0;
+
+  initBuffer(&dirs);
+  initBuffer(&text);
+
+  while(here < fmt->length)
+  { int c = fmt_chr(fmt, here);
+
+    if ( c == '~' )
+    { fmt_directive d = {0, DEFAULT, FALSE, 0, 0, FALSE};
+					/* Get the numeric argument */
+      c = fmt_chr(fmt, ++here);
+
+      if ( isDigitW(c) )
+      { d.arg = c - '0';
+
+	here++;
+	while(here < fmt->length)
+	{ c = fmt_chr(fmt, here);
+
+	  if ( isDigitW(c) )
+	  { int dw = c - '0';
+	    int arg2 = d.arg*10 + dw;
+
+	    if ( (arg2 - dw)/10 != d.arg )	/* see mul64() in pl-arith.c */
+	    { PL_error(NULL, 0, NULL, ERR_FORMAT, "argument overflow");
+	      goto out;
+	    }
+	    d.arg = arg2;
+	    here++;
+	  } else
+	    break;
+	}
+      } else if ( c == '*' )
+      { d.arg = FMT_STAR;
+	c = fmt_chr(fmt, ++here);
+      } else if ( c == '`' && here < fmt->length )
+      { d.arg = fmt_chr(fmt, ++here);
+	c = fmt_chr(fmt, ++here);
+      }
+
+      if ( c == ':' )
+      { d.colon = TRUE;
+	c = fmt_chr(fmt, ++here);
+      }
+
+      d.code = c;
+      addBuffer(&dirs, d, fmt_directive);
+    } else
+    { add_text((Buffer)&dirs, (Buffer)&text, c);
+    }
+    here++;
+  }
+
+  { size_t dsize = entriesBuffer(&dirs, fmt_directive)*sizeof(fmt_directive);
+    size_t tsize = entriesBuffer(&text, char);
+    size_t size = sizeof(*prog) + dsize + tsize;
+
+    prog = allocHeapOrHalt(size);
+    prog->size = size;
+    prog->atom = 0;
+    prog->busy = 0;
+    prog->count = entriesBuffer(&dirs, fmt_directive);
+    prog->directives = (fmt_directive*)(prog+1);
+    prog->text = (char*)prog->directives + dsize;
+    memcpy(prog->directives, baseBuffer(&dirs, fmt_directive), dsize);
+    memcpy(prog->text, baseBuffer(&text, char), tsize);
+  }
+
+out:
+  discardBuffer(&dirs);
+  discardBuffer(&text);
+
+  return prog;
+}
+
+
+static void
+free_format(fmt_program *prog)
+{ freeHeap(prog, prog->size);
+}
+
+
 		/********************************
 		*       ACTUAL FORMATTING	*
 		********************************/
 
 static bool
-do_format(IOSTREAM *fd, PL_chars_t *fmt, int argc, term_t argv, Module m)
+do_format(IOSTREAM *fd, fmt_program *prog, int argc, term_t argv, Module m)
 { GET_LD
   format_state state;			/* complete state */
   int tab_stop = 0;			/* padded tab stop */
-  unsigned int here = 0;
+  const fmt_directive *d = prog->directives;
+  const fmt_directive *e = &d[prog->count];
   int rc = TRUE;
 
   state.out = fd;
@@ -394,51 +637,34 @@ do_format(IOSTREAM *fd, PL_chars_t *fmt, int argc, term_t argv, Module m)
   else
     state.column = 0;
 
-  while(here < fmt->length)
-  { int c = get_chr_from_text(fmt, here);
+  for(; d < e; d++)
+  { int c = d->code;
 
     switch(c)
-    { case '~':
-	{ int arg = DEFAULT;		/* Numeric argument */
-	  int mod_colon = FALSE;	/* Used colon modifier */
-	  predicate_t proc;
-					/* Get the numeric argument */
-	  c = get_chr_from_text(fmt, ++here);
+    { case FMT_TEXT:
+	{ const char *s = &prog->text[d->offset];
 
-	  if ( isDigitW(c) )
-	  { arg = c - '0';
-
-	    here++;
-	    while(here < fmt->length)
-	    { c = get_chr_from_text(fmt, here);
-
-	      if ( isDigitW(c) )
-	      { int dw = c - '0';
-		int arg2 = arg*10 + dw;
+	  if ( d->ascii && d->length == 1 )
+	    rc = outchr(&state, s[0]);
+	  else if ( d->ascii )
+	    rc = outstring(&state, s, d->length);
+	  else
+	    rc = oututf8(&state, s, d->length);
+	  if ( !rc )
+	    goto out;
+	  break;
+	}
+      default:
+	{ int arg = d->arg;		/* Numeric argument */
+	  int mod_colon = d->colon;	/* Used colon modifier */
+	  predicate_t proc;
 
-		if ( (arg2 - dw)/10 != arg )	/* see mul64() in pl-arith.c */
-		{ FMT_ERROR("argument overflow");
-		}
-		arg = arg2;
-		here++;
-	      } else
-		break;
-	    }
-	  } else if ( c == '*' )
+	  if ( arg == FMT_STAR )
 	  { NEED_ARG;
 	    if ( PL_get_integer(argv, &arg) )
 	    { SHIFT;
 	    } else
 	      FMT_ERROR("no or negative integer for `*' argument");
-	    c = get_chr_from_text(fmt, ++here);
-	  } else if ( c == '`' && here < fmt->length )
-	  { arg = get_chr_from_text(fmt, ++here);
-	    c = get_chr_from_text(fmt, ++here);
-	  }
-
-	  if ( c == ':' )
-	  { mod_colon = TRUE;
-	    c = get_chr_from_text(fmt, ++here);
 	  }
 
 					/* Check for user defined format */
@@ -475,7 +701,6 @@ do_format(IOSTREAM *fd, PL_chars_t *fmt, int argc, term_t argv, Module m)
 	    if ( !rc )
 	      goto out;
 
-	    here++;
 	  } else
 	  { switch(c)			/* Build in formatting */
 	    { case 'a':			/* atomic */
@@ -488,7 +713,6 @@ do_format(IOSTREAM *fd, PL_chars_t *fmt, int argc, term_t argv, Module m)
 		  rc = outtext(&state, &txt);
                   if ( !rc )
 		    goto out;
-		  here++;
 		  break;
 		}
 	      case 'c':			/* ~c: character code */
@@ -506,7 +730,6 @@ do_format(IOSTREAM *fd, PL_chars_t *fmt, int argc, term_t argv, Module m)
 		    }
 		  } else
 		    FMT_ARG("c", argv);
-		  here++;
 		  break;
 		}
 	      case 'e':			/* exponential float */
@@ -544,7 +767,6 @@ do_format(IOSTREAM *fd, PL_chars_t *fmt, int argc, term_t argv, Module m)
 		  discardBuffer(&u.b);
                   if ( !rc )
 		    goto out;
-		  here++;
 		  break;
 		}
 	      case 'd':			/* integer */
@@ -615,7 +837,6 @@ do_format(IOSTREAM *fd, PL_chars_t *fmt, int argc, term_t argv, Module m)
 		  discardBuffer(&b);
 		  if ( !rc )
 		    goto out;
-		  here++;
 		  break;
 		}
 	      case 's':			/* string */
@@ -629,13 +850,11 @@ do_format(IOSTREAM *fd, PL_chars_t *fmt, int argc, term_t argv, Module m)
 		  SHIFT;
 		  if ( !rc )
 		    goto out;
-		  here++;
 		  break;
 		}
 	      case 'i':			/* ignore */
 		{ NEED_ARG;
 		  SHIFT;
-		  here++;
 		  break;
 		}
 		{ Func f;
@@ -697,7 +916,6 @@ do_format(IOSTREAM *fd, PL_chars_t *fmt, int argc, term_t argv, Module m)
 		    }
 		  }
 		  SHIFT;
-		  here++;
 		  break;
 		}
 	      case 'W':			/* write_term(Value, Options) */
@@ -749,7 +967,6 @@ do_format(IOSTREAM *fd, PL_chars_t *fmt, int argc, term_t argv, Module m)
 		  }
 		  SHIFT;
 		  SHIFT;
-		  here++;
 		  break;
 	       }
 	      case '@':
@@ -776,14 +993,12 @@ do_format(IOSTREAM *fd, PL_chars_t *fmt, int argc, term_t argv, Module m)
 		  }
 
 		  SHIFT;
-		  here++;
 		  break;
 	        }
 	      case '~':			/* ~ */
 		{ rc = outchr(&state, '~');
 		  if ( !rc )
 		    goto out;
-		  here++;
 		  break;
 		}
 	      case 'n':			/* \n */
@@ -797,7 +1012,6 @@ do_format(IOSTREAM *fd, PL_chars_t *fmt, int argc, term_t argv, Module m)
 		    if ( !rc )
 		      goto out;
                   }
-		  here++;
 		  break;
 		}
 	      case 't':			/* insert tab */
@@ -810,7 +1024,6 @@ do_format(IOSTREAM *fd, PL_chars_t *fmt, int argc, term_t argv, Module m)
 							: (pl_wchar_t)arg);
 		  state.rub[state.pending_rubber].size = 0;
 		  state.pending_rubber++;
-		  here++;
 		  break;
 		}
 	      case '|':			/* set tab */
@@ -834,7 +1047,6 @@ do_format(IOSTREAM *fd, PL_chars_t *fmt, int argc, term_t argv, Module m)
 		  emit_rubber(&state);
 
 		  state.column = tab_stop = stop;
-		  here++;
 		  break;
 		}
 	      default:
@@ -847,14 +1059,7 @@ do_format(IOSTREAM *fd, PL_chars_t *fmt, int argc, term_t argv, Module m)
 	      }
 	    }
 	  }
-	  break;			/* the '~' switch */
-	}
-      default:
-	{ rc = outchr(&state, c);
-	  if ( !rc )
-	    goto out;
-	  here++;
-	  break;
+	  break;			/* the directive switch */
 	}
     }
   }
@@ -895,10 +1100,11 @@ emit_rubber(format_state *state)
   const char *e = &s[entriesBuffer(&state->buffer, char)];
   struct rubber *r = state->rub;
   int rn = state->pending_rubber;
-  size_t j;
+  size_t j = 0;
 
-  for(j = 0; s <= e; j++)
-  { int chr;
+  for(;;)
+  { const char *q = s;
+    size_t upto;
 
     while ( rn && r->where == j )
     { size_t n;
@@ -911,12 +1117,14 @@ emit_rubber(format_state *state)
       rn--;
     }
 
-    if ( s < e )
-    { s = utf8_get_char(s, &chr);
-      if ( Sputcode(chr, state->out) < 0 )
-	return FALSE;
-    } else
+    if ( s >= e )
       break;
+					/* text upto the next rubber */
+    for(upto = rn ? r->where : (size_t)-1; q < e && j < upto; j++)
+      q = utf8_skip_char(q);
+    if ( Swrite_text(s, q-s, state->out) < 0 )
+      return FALSE;
+    s = q;
   }
 
   discardBuffer(&state->buffer);
@@ -829,6 +829,11 @@ set_prolog_flag_unlocked(term_t key, term_t value, int flags)
 #endif
       if ( k == ATOM_table_space )
 	LD->tabling.node_pool.limit = (size_t)i;
+      else if ( k == ATOM_table_compile_threshold )
+      { if ( i < 0 || i > UINT_MAX )
+	  return PL_domain_error("table_compile_threshold", value);
+	LD->tabling.compile_threshold = (unsigned int)i;
+      }
 #ifdef O_PLMT
       else if ( k == ATOM_shared_table_space )
 	GD->tabling.node_pool.limit = (size_t)i;
@@ -1349,6 +1354,8 @@ initPrologFlags(void)
   setPrologFlag("agc_margin",FT_INTEGER,	       GD->atoms.margin);
 #endif
   setPrologFlag("table_space", FT_INTEGER, LD->tabling.node_pool.limit);
+  setPrologFlag("table_compile_threshold", FT_INTEGER,
+		LD->tabling.compile_threshold);
   setPrologFlag("stack_limit", FT_INTEGER, LD->stacks.limit);
 #if defined(HAVE_DLOPEN) || defined(HAVE_SHL_LOAD) || defined(EMULATE_DLOPEN)
   setPrologFlag("open_shared_object",	  FT_BOOL|FF_READONLY, TRUE, 0);
@@ -34,6 +34,7 @@
     POSSIBILITY OF SUCH DAMAGE.
 */
 
+#define _GNU_SOURCE 1			/* copy_file_range(), splice() */
 #ifdef __WINDOWS__
 #include "windows/uxnt.h"
 #ifdef WIN64
@@ -104,6 +105,22 @@ locking is required.
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
+#if defined(HAVE_COPY_FILE_RANGE) || defined(HAVE_SPLICE) || \
+    (defined(HAVE_SENDFILE) && defined(HAVE_SYS_SENDFILE_H))
+#define O_KERNEL_COPY 1
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include <stdio.h>			/* sprintf() for numeric values */
 #include <assert.h>
 #ifdef SYSLIB_H
@@ -277,6 +294,41 @@ S__removebuf(IOSTREAM *s)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+S__growbuf() doubles the buffer of an SIO_ADAPTIVE stream up to
+SIO_MAXBUFSIZE.  It is called by S__fillbuf() if the previous read filled
+the entire buffer and by S__flushbuf() after emptying a full buffer, so
+only streams that move data in bulk end up with a large buffer.  Failure
+to allocate is not an error; we simply keep the current buffer.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+S__growbuf(IOSTREAM *s)
+{ if ( (s->flags & (SIO_ADAPTIVE|SIO_FBUF|SIO_USERBUF)) ==
+       (SIO_ADAPTIVE|SIO_FBUF) &&
+       s->unbuffer && s->bufsize < SIO_MAXBUFSIZE )
+  { size_t size = (size_t)s->bufsize*2;
+    size_t here = s->bufp - s->buffer;
+    size_t limit = s->limitp - s->buffer;
+    char *newunbuf;
+
+    if ( size > SIO_MAXBUFSIZE )
+      size = SIO_MAXBUFSIZE;
+    if ( !(newunbuf = realloc(s->unbuffer, size+UNDO_SIZE)) )
+      return;
+
+    s->unbuffer = newunbuf;
+    s->buffer   = newunbuf + UNDO_SIZE;
+    s->bufp     = s->buffer + here;
+    if ( (s->flags & SIO_OUTPUT) )
+      s->limitp = s->buffer + size;
+    else
+      s->limitp = s->buffer + limit;
+    s->bufsize  = (int)size;
+  }
+}
+
+
 #ifdef DEBUG_IO_LOCKS
 static char *
 Sname(IOSTREAM *s)
@@ -544,6 +596,8 @@ partial:
   if ( to == from )			/* full flush */
   { rc = s->bufp - s->buffer;
     s->bufp = s->buffer;
+    if ( rc == s->bufsize && (s->flags & SIO_ADAPTIVE) )
+      S__growbuf(s);
   } else				/* partial flush */
   { size_t left = to - from;
 
@@ -645,7 +699,9 @@ S__fillbuf(IOSTREAM *s)
       len = s->bufsize;
     } else if ( s->bufp < s->limitp )
     { len = s->limitp - s->bufp;
-      if ( len == s->bufsize )
+      if ( len == s->bufsize ||
+	   ( (s->flags & SIO_USERBUF) &&	/* e.g., a mapped file */
+	     s->limitp == s->buffer + s->bufsize ) )
       { c = char_to_int(*s->bufp++);
 	return c;
       }
@@ -654,7 +710,10 @@ S__fillbuf(IOSTREAM *s)
       s->limitp = &s->bufp[len];
       len = s->bufsize - len;
     } else
-    { s->bufp = s->limitp = s->buffer;
+    { if ( (s->flags & SIO_ADAPTIVE) &&
+	   s->limitp == s->buffer + s->bufsize )
+	S__growbuf(s);			/* last read filled the buffer */
+      s->bufp = s->limitp = s->buffer;
       len = s->bufsize;
     }
 
@@ -1185,7 +1244,7 @@ which cannot fetch a new buffer anyway.
 int
 Speekcode(IOSTREAM *s)
 { int c;
-  char *start;
+  size_t start;				/* offset: S__fillbuf() may grow */
   size_t safe = (size_t)-1;
 
   if ( !s->buffer )
@@ -1205,7 +1264,7 @@ Speekcode(IOSTREAM *s)
     memcpy(s->buffer-safe, s->bufp, safe);
   }
 
-  start = s->bufp;
+  start = s->bufp - s->buffer;
   if ( s->position )
   { IOPOS *psave = s->position;
     s->position = NULL;
@@ -1219,8 +1278,8 @@ Speekcode(IOSTREAM *s)
 
   s->flags &= ~(SIO_FEOF|SIO_FEOF2);
 
-  if ( s->bufp > start )
-  { s->bufp = start;
+  if ( s->bufp > s->buffer+start )
+  { s->bufp = s->buffer+start;
   } else if ( c != -1 )
   { assert(safe != (size_t)-1);
     s->bufp = s->buffer-safe;
@@ -1269,6 +1328,47 @@ Sgetw(IOSTREAM *s)
 		 *	    FREAD/FWRITE	*
 		 *******************************/
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Bulk transfers on plain file streams bypass the stream buffer using
+readv()/writev():  Sfwrite() writes the pending buffer and the user data
+in one system call and Sfread() reads directly into the user data while
+topping up the stream buffer with the remainder.  S__bulkfd() returns
+the file descriptor if this is safe, i.e., the stream uses the plain file
+functions without a timeout or filter, or -1 otherwise.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#if defined(HAVE_READV) || defined(HAVE_WRITEV)
+static int
+S__bulkfd(IOSTREAM *s)
+{ if ( s->functions == &Sfilefunctions && s->timeout < 0 &&
+       !s->downstream && s->buffer && !(s->flags & SIO_USERBUF) )
+    return (int)(intptr_t)s->handle;
+
+  return -1;
+}
+#endif
+
+
+static void
+S__byteswritten(IOSTREAM *s, const char *buf, size_t n)
+{ IOPOS *p;
+
+  if ( n == 0 )
+    return;
+
+  if ( (p=s->position) )
+  { const char *e = buf+n;
+
+    p->byteno += n;
+    for(; buf < e; buf++)
+    { update_linepos(s, buf[0]&0xff);
+      p->charno++;
+    }
+  }
+  s->lastc = buf[n-1]&0xff;
+}
+
+
 size_t
 Sfread(void *data, size_t size, size_t elms, IOSTREAM *s)
 { size_t chars = size * elms;
@@ -1302,6 +1402,43 @@ Sfread(void *data, size_t size, size_t elms, IOSTREAM *s)
 	}
       }
 
+#ifdef HAVE_READV
+      if ( chars >= (size_t)s->bufsize &&
+	   !(s->flags & (SIO_FEOF|SIO_FERR|SIO_NBUF)) )
+      { int fd = S__bulkfd(s);
+
+	if ( fd >= 0 )
+	{ struct iovec iov[2];
+	  ssize_t n;
+
+	  iov[0].iov_base = buf;
+	  iov[0].iov_len  = chars;
+	  iov[1].iov_base = s->buffer;
+	  iov[1].iov_len  = s->bufsize;
+
+	  if ( (n = readv(fd, iov, 2)) > 0 )
+	  { if ( (size_t)n <= chars )
+	    { buf   += n;
+	      chars -= n;
+	      s->bufp = s->limitp = s->buffer;
+	    } else
+	    { s->bufp   = s->buffer;
+	      s->limitp = s->buffer + (n-chars);
+	      chars = 0;
+	    }
+	    continue;
+	  } else if ( n == 0 )
+	  { if ( !(s->flags & SIO_NOFEOF) )
+	      s->flags |= SIO_FEOF;
+	    break;
+	  } else if ( errno != EINTR )
+	  { S__seterror(s);
+	    break;
+	  }				/* EINTR: let S__fillbuf() handle it */
+	}
+      }
+#endif
+
       if ( (c = S__fillbuf(s)) == EOF )
 	break;
 
@@ -1314,20 +1451,370 @@ Sfread(void *data, size_t size, size_t elms, IOSTREAM *s)
 }
 
 
+#ifdef HAVE_WRITEV
+/* Write the pending buffer followed by len bytes from buf.  Returns the
+   number of bytes from buf written or -1 on error.
+*/
+
+static ssize_t
+S__writev(IOSTREAM *s, int fd, const char *buf, size_t len)
+{ struct iovec iov[2];
+  size_t pending = s->bufp - s->buffer;
+  ssize_t n;
+
+  for(;;)
+  { iov[0].iov_base = s->buffer;
+    iov[0].iov_len  = pending;
+    iov[1].iov_base = (void*)buf;
+    iov[1].iov_len  = len;
+
+    if ( (n = writev(fd, iov, 2)) < 0 )
+    { if ( errno == EINTR )
+      { if ( PL_handle_signals() < 0 )
+	{ Sset_exception(s, PL_exception(0));
+	  errno = EPLEXCEPTION;
+	  return -1;
+	}
+	continue;
+      }
+      S__seterror(s);
+      return -1;
+    }
+    if ( n == 0 )
+    { errno = ENOSPC;
+      S__seterror(s);
+      return -1;
+    }
+
+    if ( (size_t)n < pending )
+    { memmove(s->buffer, s->buffer+n, pending-n);
+      pending -= n;
+      s->bufp = s->buffer+pending;
+    } else
+    { s->bufp = s->buffer;
+      return n-pending;
+    }
+  }
+}
+#endif
+
+
 size_t
 Sfwrite(const void *data, size_t size, size_t elms, IOSTREAM *s)
 { size_t chars = size * elms;
   const char *buf = data;
 
-  for( ; chars > 0; chars-- )
-  { if ( Sputc(*buf++, s) < 0 )
-      break;
+  if ( s->buffer && !(s->flags & (SIO_NBUF|SIO_LBUF)) )
+  { while( chars > 0 )
+    { size_t avail = s->limitp - s->bufp;
+
+#ifdef HAVE_WRITEV
+      if ( chars >= (size_t)s->bufsize && chars > avail )
+      { int fd = S__bulkfd(s);
+
+	if ( fd >= 0 )
+	{ ssize_t n;
+
+	  if ( (n=S__writev(s, fd, buf, chars)) < 0 )
+	    break;
+	  S__byteswritten(s, buf, n);
+	  buf += n;
+	  chars -= n;
+	  continue;
+	}
+      }
+#endif
+
+      if ( avail == 0 )
+      { if ( S__flushbuf(s) <= 0 )
+	  break;
+	continue;
+      }
+
+      if ( avail > chars )
+	avail = chars;
+      memcpy(s->bufp, buf, avail);
+      s->bufp += avail;
+      S__byteswritten(s, buf, avail);
+      buf += avail;
+      chars -= avail;
+    }
+  } else
+  { for( ; chars > 0; chars-- )
+    { if ( Sputc(*buf++, s) < 0 )
+	break;
+    }
   }
 
   return (size*elms - chars)/size;
 }
 
 
+		 /*******************************
+		 *	       COPY		*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Scopy() copies up to len bytes (all if len < 0) from in to out without
+decoding.  The caller must ensure this is the same as copying the
+characters: both streams use the same encoding and do not translate
+newlines, and out is buffered.  Buffered input is moved to the output
+buffer with memcpy().  If both streams are plain file descriptors that
+do not keep line information, i.e., they are binary or do not record
+the position, the remainder is copied by the kernel using copy_file_range(), sendfile() or
+splice().  Otherwise we copy from one stream buffer to the other.
+
+Returns the number of bytes copied or -1 on error.  The error is recorded
+on the stream that caused it.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define COPY_CHUNK (8*1024*1024)	/* Max bytes between signal checks */
+
+static void
+S__copypos(IOSTREAM *s, const char *buf, size_t n)
+{ IOPOS *p;
+
+  if ( (p=s->position) )
+  { const char *e = buf+n;
+    int utf8 = (s->encoding == ENC_UTF8);
+
+    p->byteno += n;
+    for(; buf < e; buf++)
+    { int c = buf[0]&0xff;
+
+      if ( !utf8 || (c&0xc0) != 0x80 )	/* not a UTF-8 continuation */
+      { update_linepos(s, c);
+	p->charno++;
+      }
+    }
+  }
+}
+
+
+static int
+S__copyout(IOSTREAM *s, const char *buf, size_t n)
+{ const char *e = buf+n;
+
+  if ( n == 0 )
+    return 0;
+
+  S__copypos(s, buf, n);
+  s->lastc = e[-1]&0xff;
+
+  while( buf < e )
+  { size_t avail;
+
+    if ( !s->buffer )
+    { if ( S__setbuf(s, NULL, 0) == (size_t)-1 )
+	return -1;
+    } else if ( (avail = s->limitp - s->bufp) == 0 )
+    { if ( S__flushbuf(s) <= 0 )
+	return -1;
+    } else
+    { if ( avail > (size_t)(e-buf) )
+	avail = e-buf;
+      memcpy(s->bufp, buf, avail);
+      s->bufp += avail;
+      buf += avail;
+    }
+  }
+
+  return 0;
+}
+
+
+#ifdef O_KERNEL_COPY
+typedef enum
+{ KC_COPY_FILE_RANGE = 0,
+  KC_SENDFILE,
+  KC_SPLICE,
+  KC_NONE
+} kernel_copy;
+
+static int
+S__copyfd(IOSTREAM *s)
+{ if ( s->functions == &Sfilefunctions && s->timeout < 0 &&
+       !s->downstream &&
+       ( !s->position || !(s->flags & SIO_TEXT) ) ) /* no line info needed */
+    return (int)(intptr_t)s->handle;
+
+  return -1;
+}
+
+/* Copy at most len bytes using method *how.  Returns the number of
+   bytes copied, 0 at end of file or -1 on error.  If the method is not
+   supported, try the next.  Returns -2 if no method applies.
+*/
+
+static ssize_t
+S__kernelcopy(int in, int out, size_t len, kernel_copy *how, int64_t done)
+{ ssize_t n;
+
+  for(;;)
+  { switch(*how)
+    { case KC_COPY_FILE_RANGE:
+#ifdef HAVE_COPY_FILE_RANGE
+	n = copy_file_range(in, NULL, out, NULL, len, 0);
+	if ( n == 0 && done == 0 )	/* e.g., /proc files claim size 0 */
+	{ *how = KC_SENDFILE;
+	  continue;
+	}
+	break;
+#else
+	*how = KC_SENDFILE;
+	continue;
+#endif
+      case KC_SENDFILE:
+#if defined(HAVE_SENDFILE) && defined(HAVE_SYS_SENDFILE_H)
+	n = sendfile(out, in, NULL, len);
+	break;
+#else
+	*how = KC_SPLICE;
+	continue;
+#endif
+      case KC_SPLICE:
+#ifdef HAVE_SPLICE
+	n = splice(in, NULL, out, NULL, len, SPLICE_F_MOVE);
+	break;
+#else
+	*how = KC_NONE;
+	continue;
+#endif
+      default:
+	return -2;
+    }
+
+    if ( n >= 0 )
+      return n;
+
+    switch(errno)
+    { case EINTR:
+	if ( PL_handle_signals() < 0 )
+	{ errno = EPLEXCEPTION;
+	  return -1;
+	}
+	continue;
+      case EINVAL:
+      case EXDEV:
+      case EBADF:			/* e.g., O_APPEND output */
+      case ENOSYS:
+#ifdef EOPNOTSUPP
+      case EOPNOTSUPP:
+#endif
+      case EAGAIN:
+	*how = *how+1;			/* try the next method */
+	continue;
+      default:
+	return -1;
+    }
+  }
+}
+#endif /*O_KERNEL_COPY*/
+
+
+int64_t
+Scopy(IOSTREAM *in, IOSTREAM *out, int64_t len)
+{ int64_t done = 0;
+  size_t chunk = 0;
+#ifdef O_KERNEL_COPY
+  kernel_copy how = KC_COPY_FILE_RANGE;
+#endif
+
+  while( len < 0 || done < len )
+  { size_t max = (len < 0 || len-done > COPY_CHUNK ? COPY_CHUNK
+						  : (size_t)(len-done));
+
+    if ( chunk >= COPY_CHUNK )
+    { chunk = 0;
+      if ( PL_handle_signals() < 0 )
+      { Sset_exception(out, PL_exception(0));
+	return -1;
+      }
+    }
+
+    if ( in->bufp < in->limitp )	/* buffered input */
+    { size_t n = in->limitp - in->bufp;
+
+      if ( n > max )
+	n = max;
+      S__copypos(in, in->bufp, n);
+      if ( S__copyout(out, in->bufp, n) < 0 )
+	return -1;
+      in->bufp += n;
+      done += n;
+      chunk += n;
+      continue;
+    }
+
+#ifdef O_KERNEL_COPY
+    if ( how != KC_NONE && !(in->flags & (SIO_FEOF|SIO_FERR)) )
+    { int infd = S__copyfd(in);
+      int outfd = S__copyfd(out);
+
+      if ( infd >= 0 && outfd >= 0 )
+      { ssize_t n;
+
+	if ( Sflush(out) < 0 )
+	  return -1;
+	if ( (n=S__kernelcopy(infd, outfd, max, &how, done)) > 0 )
+	{ IOPOS *p;
+
+	  if ( (p=in->position) )
+	  { p->byteno += n;
+	    p->charno += n;
+	    in->flags |= (SIO_NOLINENO|SIO_NOLINEPOS);
+	  }
+	  if ( (p=out->position) )
+	  { p->byteno += n;
+	    p->charno += n;
+	    out->flags |= (SIO_NOLINENO|SIO_NOLINEPOS);
+	  }
+	  done += n;
+	  chunk += n;
+	  continue;
+	} else if ( n == 0 )
+	{ if ( !(in->flags & SIO_NOFEOF) )
+	    in->flags |= SIO_FEOF;
+	  break;
+	} else if ( n == -1 )
+	{ if ( errno == EPLEXCEPTION )
+	    Sset_exception(out, PL_exception(0));
+	  else
+	    S__seterror(out);		/* can't tell; in is more likely ok */
+	  return -1;
+	}				/* -2: no kernel method */
+      }
+    }
+#endif
+
+    { int c = S__fillbuf(in);		/* refill (or get a byte if NBUF) */
+
+      if ( c < 0 )
+      { if ( Sferror(in) )
+	  return -1;
+	break;
+      }
+      if ( in->buffer && in->bufp > in->buffer )
+      { in->bufp--;			/* push back into the buffer */
+      } else
+      { char b = (char)c;
+
+	S__copypos(in, &b, 1);
+	if ( S__copyout(out, &b, 1) < 0 )
+	  return -1;
+	done++;
+	chunk++;
+      }
+    }
+  }
+
+  if ( (out->flags & SIO_LBUF) && S__flushbuf(out) < 0 )
+    return -1;
+
+  return done;
+}
+
+
 		 /*******************************
 		 *	       PENDING		*
 		 *******************************/
@@ -2023,44 +2510,380 @@ Sgets(char *buf)
 }
 
 
-int
-Sfputs(const char *q, IOSTREAM *s)
-{ for( ; *q; q++)
-  { if ( Sputcode(*q&0xff, s) < 0 )
-      return EOF;
-  }
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Sfputs() and Sfputsn() emit ISO Latin-1 text.  If the stream has no tee
+and printable ASCII is emitted unmodified by its encoding, runs of such
+characters are copied directly into the stream buffer.  As these
+characters contain no layout other than space, updating the position
+amounts to adding the run length.  Other characters are passed to
+Sputcode().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-  return 0;
-}
+#define isPrintASCII(c) ((c) >= ' ' && (c) <= '~')
 
+static int
+ascii_passthrough(IOSTREAM *s)
+{ if ( (s->flags & SIO_NBUF) || s->tee )
+    return FALSE;
 
-int
-Sputs(const char *q)
-{ return Sfputs(q, Soutput);
+  switch(s->encoding)
+  { case ENC_OCTET:
+    case ENC_ASCII:
+    case ENC_ISO_LATIN_1:
+    case ENC_UTF8:
+      return TRUE;
+    case ENC_ANSI:
+      return !s->mbstate || mbsinit(s->mbstate);
+    default:
+      return FALSE;
+  }
 }
 
 
-		 /*******************************
-		 *	       PRINTF		*
-		 *******************************/
-
-int
-Sfprintf(IOSTREAM *s, const char *fm, ...)
-{ va_list args;
-  int rval;
+static const unsigned char *
+skip_print_ascii(const unsigned char *p, const unsigned char *e)
+{
+#ifdef __SSE2__
+  const __m128i lo  = _mm_set1_epi8(' ');
+  const __m128i del = _mm_set1_epi8(0x7f);
+
+  while( e-p >= 16 )
+  { __m128i v = _mm_loadu_si128((const __m128i*)p);
+    __m128i stop;				/* signed: >= 0x80 is < ' ' */
+    int mask;
+
+    stop = _mm_or_si128(_mm_cmplt_epi8(v, lo), _mm_cmpeq_epi8(v, del));
+    if ( (mask=_mm_movemask_epi8(stop)) )
+      return p + __builtin_ctz(mask);
+    p += 16;
+  }
+#endif
 
-  va_start(args, fm);
-  rval = Svfprintf(s, fm, args);
-  va_end(args);
+  while( p < e && isPrintASCII(*p) )
+    p++;
 
-  return rval;
+  return p;
 }
 
 
-int
-Sprintf(const char *fm, ...)
-{ va_list args;
-  int rval;
+/* Copy a run of printable ASCII from p into the buffer of s, which must
+   have room.  Returns the end of the copied run.
+*/
+
+static const unsigned char *
+put_ascii_run(const unsigned char *p, const unsigned char *e, IOSTREAM *s)
+{ size_t room = s->limitp - s->bufp;
+  const unsigned char *r;
+  size_t n;
+
+  r = skip_print_ascii(p, (size_t)(e-p) > room ? p+room : e);
+  if ( (n = r-p) )
+  { memcpy(s->bufp, p, n);
+    s->bufp += n;
+    s->lastc = r[-1];
+    if ( s->position )
+    { s->position->byteno  += n;
+      s->position->charno  += n;
+      s->position->linepos += n;
+    }
+  }
+
+  return r;
+}
+
+
+int
+Sfputsn(const char *q, size_t len, IOSTREAM *s)
+{ const unsigned char *p = (const unsigned char *)q;
+  const unsigned char *e = p+len;
+
+  if ( !ascii_passthrough(s) )
+  { for( ; p < e; p++)
+    { if ( Sputcode(*p, s) < 0 )
+	return EOF;
+    }
+
+    return 0;
+  }
+
+  while( p < e )
+  { if ( isPrintASCII(*p) && s->bufp < s->limitp )
+    { p = put_ascii_run(p, e, s);
+    } else
+    { if ( Sputcode(*p++, s) < 0 )
+	return EOF;
+    }
+  }
+
+  return 0;
+}
+
+
+int
+Sfputs(const char *q, IOSTREAM *s)
+{ return Sfputsn(q, strlen(q), s);
+}
+
+
+int
+Sputs(const char *q)
+{ return Sfputs(q, Soutput);
+}
+
+
+		 /*******************************
+		 *	     BULK TEXT		*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Sread_text() and Swrite_text() move UTF-8 text between a memory buffer
+and a stream, avoiding the per-character Sgetcode() and Sputcode() calls
+for characters that need no special treatment.
+
+Sread_text() decodes characters from the stream's *current buffer* into
+buf as UTF-8.  It never fills the buffer.  Reading stops if buf is full,
+if *chars characters have been read, if the buffer is exhausted or if
+the next character is in `stop' or needs Sgetcode().  The latter applies
+to \r on text streams, malformed or incomplete multibyte sequences and
+anything that cannot be decoded trivially.  `stop' is a bitmap over the
+ASCII characters and may be NULL.  On return, *chars is the number of
+characters read, and the return value is the number of bytes stored.
+The caller normally continues with Sgetcode(), which refills the buffer.
+Positions are updated as Sgetcode() would do.
+
+Swrite_text() emits UTF-8 text.  Runs of printable ASCII are copied as
+by Sfputsn().  If the stream is UTF-8 encoded, multibyte sequences are
+copied as well.  Everything else goes through Sputcode().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define isStopChar(stop, c) ((stop)[(c)>>3] & (1<<((c)&7)))
+
+static int
+read_text_encoding(IOSTREAM *s)
+{ if ( s->tee )
+    return ENC_UNKNOWN;
+
+  switch(s->encoding)
+  { case ENC_OCTET:
+    case ENC_ASCII:
+    case ENC_ISO_LATIN_1:
+    case ENC_UTF8:
+      return s->encoding;
+    case ENC_ANSI:
+      if ( !s->mbstate || mbsinit(s->mbstate) )
+	return ENC_ANSI;
+    /*FALLTHROUGH*/
+    default:
+      return ENC_UNKNOWN;
+  }
+}
+
+
+/* Length of the canonical UTF-8 sequence at p, or 0 if it is malformed,
+   overlong or incomplete before e.
+*/
+
+static size_t
+utf8_seq_length(const unsigned char *p, const unsigned char *e)
+{ size_t avail = e-p;
+  int c = p[0];
+
+  if ( c >= 0xc2 && c <= 0xdf )
+  { if ( avail >= 2 && ISUTF8_CB(p[1]) )
+      return 2;
+  } else if ( c >= 0xe0 && c <= 0xef )
+  { if ( avail >= 3 && ISUTF8_CB(p[1]) && ISUTF8_CB(p[2]) &&
+	 (c != 0xe0 || p[1] >= 0xa0) )
+      return 3;
+  } else if ( c >= 0xf0 && c <= 0xf4 )
+  { if ( avail >= 4 && ISUTF8_CB(p[1]) && ISUTF8_CB(p[2]) &&
+	 ISUTF8_CB(p[3]) && (c != 0xf0 || p[1] >= 0x90) )
+      return 4;
+  }
+
+  return 0;
+}
+
+
+size_t
+Sread_text(IOSTREAM *s, char *buf, size_t size, size_t *chars,
+	   const unsigned char *stop)
+{ const unsigned char *in0 = (const unsigned char *)s->bufp;
+  const unsigned char *in  = in0;
+  const unsigned char *ie  = (const unsigned char *)s->limitp;
+  unsigned char *o  = (unsigned char *)buf;
+  unsigned char *oe = o+size;
+  size_t nc = 0, maxc = *chars;
+  int enc = read_text_encoding(s);
+  int runs = TRUE;
+  IOPOS *pos = s->position;
+
+  if ( enc == ENC_UNKNOWN || !in )
+  { *chars = 0;
+    return 0;
+  }
+  if ( stop )
+  { int i;
+
+    for(i=' '/8; i<16; i++)		/* any printable stop characters? */
+    { if ( stop[i] )
+      { runs = FALSE;
+	break;
+      }
+    }
+  }
+
+  while( in < ie && nc < maxc )
+  { int c = *in;
+
+    if ( c < 0x80 )
+    { if ( runs && isPrintASCII(c) )
+      { size_t n = ie-in;
+	const unsigned char *r;
+
+	if ( n > (size_t)(oe-o) )
+	  n = oe-o;
+	if ( n > maxc-nc )
+	  n = maxc-nc;
+	if ( n == 0 )
+	  break;
+	r = skip_print_ascii(in, in+n);
+	n = r-in;
+	memcpy(o, in, n);
+	o  += n;
+	in  = r;
+	nc += n;
+	if ( pos )
+	  pos->linepos += n;
+	continue;
+      }
+
+      if ( stop && isStopChar(stop, c) )
+	break;
+      if ( !isPrintASCII(c) )
+      { if ( c == '\r' && (s->flags&SIO_TEXT) )
+	  break;
+	if ( enc == ENC_ANSI && c != '\n' && c != '\t' )
+	  break;			/* may shift state */
+      }
+      if ( o >= oe )
+	break;
+      *o++ = c;
+      in++;
+      nc++;
+      if ( pos )
+	update_linepos(s, c);
+      continue;
+    }
+
+    switch(enc)
+    { case ENC_OCTET:
+      case ENC_ISO_LATIN_1:
+	if ( oe-o < 2 )
+	  goto out;
+	*o++ = 0xc0|(c>>6);
+	*o++ = 0x80|(c&0x3f);
+	in++;
+	break;
+      case ENC_UTF8:
+      { size_t n = utf8_seq_length(in, ie);
+
+	if ( n == 0 || (size_t)(oe-o) < n )
+	  goto out;
+	memcpy(o, in, n);
+	o  += n;
+	in += n;
+	break;
+      }
+      default:
+	goto out;
+    }
+    nc++;
+    if ( pos )
+      pos->linepos++;
+  }
+
+out:
+  if ( pos )
+  { pos->byteno += in-in0;
+    pos->charno += nc;
+  }
+  s->bufp = (char *)in;
+  *chars = nc;
+
+  return o - (unsigned char *)buf;
+}
+
+
+int
+Swrite_text(const char *utf8, size_t len, IOSTREAM *s)
+{ const unsigned char *p = (const unsigned char *)utf8;
+  const unsigned char *e = p+len;
+  int passthrough = ascii_passthrough(s);
+
+  while( p < e )
+  { if ( passthrough && s->bufp < s->limitp )
+    { if ( isPrintASCII(*p) )
+      { p = put_ascii_run(p, e, s);
+	continue;
+      }
+      if ( *p >= 0x80 && s->encoding == ENC_UTF8 )
+      { size_t n = utf8_seq_length(p, e);
+
+	if ( n && (size_t)(s->limitp - s->bufp) >= n )
+	{ int c;
+
+	  utf8_get_char((const char *)p, &c);
+	  memcpy(s->bufp, p, n);
+	  s->bufp += n;
+	  p += n;
+	  s->lastc = c;
+	  if ( s->position )
+	  { s->position->byteno += n;
+	    s->position->charno++;
+	    s->position->linepos++;
+	  }
+	  continue;
+	}
+      }
+    }
+
+    { int c;
+
+      if ( *p < 0x80 )
+	c = *p++;
+      else
+	p = (const unsigned char *)utf8_get_char((const char *)p, &c);
+      if ( Sputcode(c, s) < 0 )
+	return EOF;
+    }
+  }
+
+  return 0;
+}
+
+
+		 /*******************************
+		 *	       PRINTF		*
+		 *******************************/
+
+int
+Sfprintf(IOSTREAM *s, const char *fm, ...)
+{ va_list args;
+  int rval;
+
+  va_start(args, fm);
+  rval = Svfprintf(s, fm, args);
+  va_end(args);
+
+  return rval;
+}
+
+
+int
+Sprintf(const char *fm, ...)
+{ va_list args;
+  int rval;
 
   va_start(args, fm);
   rval = Svfprintf(Soutput, fm, args);
@@ -2988,6 +3811,667 @@ IOFUNCTIONS Sttyfunctions =
 };
 
 
+		 /*******************************
+		 *	  IO_URING FILES	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Suringfunctions implements regular files on top of Linux io_uring.  Each
+stream owns a small ring and two chunk buffers.  Input streams keep both
+chunks in flight (read-ahead), so the next chunk is read by the kernel
+while Prolog processes the current one.  Output streams copy the data
+into a chunk, submit it and return immediately (write-behind).  Errors
+of a background write are reported by the next write, flush or close.
+Completions are reaped lazily from the completion queue; we only wait if
+we need the buffer of a request that is still in flight.
+
+We talk to the kernel using the raw system calls to avoid a dependency
+on liburing.  If the ring cannot be created (old kernel, seccomp), or
+the file is not a regular file, Sopen_file() silently falls back to the
+normal Sfilefunctions.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#if defined(HAVE_LINUX_IO_URING_H) && defined(HAVE_SYS_SYSCALL_H) && \
+    defined(HAVE_SYS_MMAN_H)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#ifdef __NR_io_uring_setup
+#define O_IO_URING 1
+#endif
+#endif
+
+#ifdef O_IO_URING
+
+#define URING_CHUNK	SIO_MAXBUFSIZE	/* bytes per request */
+#define URING_SLOTS	2		/* requests in flight */
+
+typedef enum
+{ US_IDLE = 0,				/* no request */
+  US_BUSY,				/* submitted */
+  US_DONE				/* completed, result is valid */
+} uring_state;
+
+typedef struct uring_slot
+{ char	       *data;			/* chunk buffer */
+  size_t	size;			/* requested size */
+  size_t	here;			/* input: consumed from data */
+  int64_t	offset;			/* file offset of the request */
+  ssize_t	result;			/* result of the request */
+  uring_state	state;			/* US_* */
+  struct iovec	iov;			/* request for READV/WRITEV */
+} uring_slot;
+
+typedef struct uring_file
+{ int		fd;			/* the file */
+  int		ring;			/* the io_uring */
+  int		output;			/* write-behind stream */
+  int		next;			/* slot to use next */
+  int		error;			/* errno of failed background write */
+  int64_t	offset;			/* file offset of next request */
+  unsigned     *sq_tail;
+  unsigned     *sq_mask;
+  unsigned     *sq_array;
+  unsigned     *cq_head;
+  unsigned     *cq_tail;
+  unsigned     *cq_mask;
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+  void	       *sq_map;			/* mmapped rings */
+  size_t	sq_map_size;
+  void	       *cq_map;
+  size_t	cq_map_size;
+  size_t	sqes_size;
+  uring_slot	slot[URING_SLOTS];
+} uring_file;
+
+
+static void
+uring_free(uring_file *uf)
+{ int i;
+
+  if ( uf->sqes )
+    munmap(uf->sqes, uf->sqes_size);
+  if ( uf->cq_map && uf->cq_map != uf->sq_map )
+    munmap(uf->cq_map, uf->cq_map_size);
+  if ( uf->sq_map )
+    munmap(uf->sq_map, uf->sq_map_size);
+  if ( uf->ring >= 0 )
+    close(uf->ring);
+  for(i=0; i<URING_SLOTS; i++)
+  { if ( uf->slot[i].data )
+      free(uf->slot[i].data);
+  }
+  free(uf);
+}
+
+
+static uring_file *
+uring_create(int fd, int flags)
+{ struct io_uring_params p;
+  struct stat st;
+  uring_file *uf;
+  char *sq, *cq;
+  int i;
+
+  if ( fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) )
+    return NULL;
+  if ( !(uf = calloc(1, sizeof(*uf))) )
+    return NULL;
+  uf->fd     = fd;
+  uf->output = !!(flags&SIO_OUTPUT);
+  uf->ring   = -1;
+
+  memset(&p, 0, sizeof(p));
+  if ( (uf->ring = (int)syscall(__NR_io_uring_setup, URING_SLOTS, &p)) < 0 )
+    goto failed;
+
+  uf->sq_map_size = p.sq_off.array + p.sq_entries*sizeof(unsigned);
+  uf->cq_map_size = p.cq_off.cqes + p.cq_entries*sizeof(struct io_uring_cqe);
+#ifdef IORING_FEAT_SINGLE_MMAP
+  if ( (p.features & IORING_FEAT_SINGLE_MMAP) )
+  { if ( uf->cq_map_size > uf->sq_map_size )
+      uf->sq_map_size = uf->cq_map_size;
+    uf->cq_map_size = uf->sq_map_size;
+  }
+#endif
+
+  uf->sq_map = mmap(NULL, uf->sq_map_size, PROT_READ|PROT_WRITE,
+		    MAP_SHARED|MAP_POPULATE, uf->ring, IORING_OFF_SQ_RING);
+  if ( uf->sq_map == MAP_FAILED )
+  { uf->sq_map = NULL;
+    goto failed;
+  }
+#ifdef IORING_FEAT_SINGLE_MMAP
+  if ( (p.features & IORING_FEAT_SINGLE_MMAP) )
+  { uf->cq_map = uf->sq_map;
+  } else
+#endif
+  { uf->cq_map = mmap(NULL, uf->cq_map_size, PROT_READ|PROT_WRITE,
+		      MAP_SHARED|MAP_POPULATE, uf->ring, IORING_OFF_CQ_RING);
+    if ( uf->cq_map == MAP_FAILED )
+    { uf->cq_map = NULL;
+      goto failed;
+    }
+  }
+  uf->sqes_size = p.sq_entries*sizeof(struct io_uring_sqe);
+  uf->sqes = mmap(NULL, uf->sqes_size, PROT_READ|PROT_WRITE,
+		  MAP_SHARED|MAP_POPULATE, uf->ring, IORING_OFF_SQES);
+  if ( uf->sqes == MAP_FAILED )
+  { uf->sqes = NULL;
+    goto failed;
+  }
+
+  sq = uf->sq_map;
+  cq = uf->cq_map;
+  uf->sq_tail  = (unsigned*)(sq + p.sq_off.tail);
+  uf->sq_mask  = (unsigned*)(sq + p.sq_off.ring_mask);
+  uf->sq_array = (unsigned*)(sq + p.sq_off.array);
+  uf->cq_head  = (unsigned*)(cq + p.cq_off.head);
+  uf->cq_tail  = (unsigned*)(cq + p.cq_off.tail);
+  uf->cq_mask  = (unsigned*)(cq + p.cq_off.ring_mask);
+  uf->cqes     = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+
+  for(i=0; i<URING_SLOTS; i++)
+  { if ( !(uf->slot[i].data = malloc(URING_CHUNK)) )
+      goto failed;
+  }
+
+  if ( (uf->offset = lseek(fd, 0,
+			   (flags&SIO_APPEND) ? SEEK_END : SEEK_CUR)) < 0 )
+    goto failed;
+
+  return uf;
+
+failed:
+  uring_free(uf);
+  return NULL;
+}
+
+
+static int
+uring_enter(uring_file *uf, unsigned submit, unsigned wait)
+{ for(;;)
+  { long rc = syscall(__NR_io_uring_enter, uf->ring, submit, wait,
+		      wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+
+    if ( rc >= 0 )
+      return 0;
+    if ( errno != EINTR )
+      return -1;
+  }
+}
+
+
+static int
+uring_submit(uring_file *uf, uring_slot *sl, size_t size)
+{ unsigned tail = *uf->sq_tail;
+  unsigned idx  = tail & *uf->sq_mask;
+  struct io_uring_sqe *sqe = &uf->sqes[idx];
+
+  sl->iov.iov_base = sl->data;
+  sl->iov.iov_len  = size;
+  sl->size	   = size;
+  sl->here	   = 0;
+  sl->offset	   = uf->offset;
+  sl->state	   = US_BUSY;
+
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode    = uf->output ? IORING_OP_WRITEV : IORING_OP_READV;
+  sqe->fd        = uf->fd;
+  sqe->addr      = (uintptr_t)&sl->iov;
+  sqe->len       = 1;
+  sqe->off       = (uint64_t)uf->offset;
+  sqe->user_data = sl - uf->slot;
+  uf->sq_array[idx] = idx;
+  __atomic_store_n(uf->sq_tail, tail+1, __ATOMIC_RELEASE);
+
+  if ( uring_enter(uf, 1, 0) < 0 )	/* not consumed by the kernel */
+  { __atomic_store_n(uf->sq_tail, tail, __ATOMIC_RELEASE);
+    sl->state = US_IDLE;
+    return -1;
+  }
+  uf->offset += size;
+
+  return 0;
+}
+
+
+static void
+uring_reap(uring_file *uf)
+{ unsigned head = *uf->cq_head;
+  unsigned tail = __atomic_load_n(uf->cq_tail, __ATOMIC_ACQUIRE);
+
+  for(; head != tail; head++)
+  { struct io_uring_cqe *cqe = &uf->cqes[head & *uf->cq_mask];
+    uring_slot *sl = &uf->slot[cqe->user_data];
+
+    sl->result = cqe->res;
+    sl->state  = US_DONE;
+  }
+  __atomic_store_n(uf->cq_head, head, __ATOMIC_RELEASE);
+}
+
+
+static int
+uring_wait(uring_file *uf, uring_slot *sl)
+{ for(;;)
+  { uring_reap(uf);
+    if ( sl->state != US_BUSY )
+      return 0;
+    if ( uring_enter(uf, 0, 1) < 0 )
+      return -1;
+  }
+}
+
+
+/* Wait for a completed write and check its result.  Errors are kept in
+   uf->error, such that they are reported exactly once.
+*/
+
+static int
+uring_write_done(uring_file *uf, uring_slot *sl)
+{ if ( sl->state == US_BUSY && uring_wait(uf, sl) < 0 )
+    return -1;
+  if ( sl->state == US_DONE )
+  { sl->state = US_IDLE;
+    if ( sl->result < 0 )
+      uf->error = (int)-sl->result;
+    else if ( (size_t)sl->result < sl->size )
+      uf->error = ENOSPC;
+  }
+  if ( uf->error )
+  { errno = uf->error;
+    uf->error = 0;
+    return -1;
+  }
+
+  return 0;
+}
+
+
+static int
+uring_drain(uring_file *uf)
+{ int i, rc = 0;
+
+  for(i=0; i<URING_SLOTS; i++)
+  { int n = (uf->next+i)%URING_SLOTS;	/* in submission order */
+
+    if ( uf->output )
+    { if ( uring_write_done(uf, &uf->slot[n]) < 0 )
+	rc = -1;
+    } else
+    { if ( uf->slot[n].state == US_BUSY &&
+	   uring_wait(uf, &uf->slot[n]) < 0 )
+	rc = -1;
+      uf->slot[n].state = US_IDLE;
+    }
+  }
+
+  return rc;
+}
+
+
+/* Offset of the first byte not yet handed to (input) or accepted from
+   (output) the stream.
+*/
+
+static int64_t
+uring_tell(uring_file *uf)
+{ if ( !uf->output )
+  { uring_slot *sl = &uf->slot[uf->next];
+
+    if ( sl->state == US_DONE && sl->result >= 0 )
+      return sl->offset + sl->here;
+    if ( sl->state != US_IDLE )
+      return sl->offset;
+  }
+
+  return uf->offset;
+}
+
+
+static void
+uring_read_ahead(uring_file *uf)
+{ int i;
+
+  for(i=0; i<URING_SLOTS; i++)
+  { uring_slot *sl = &uf->slot[(uf->next+i)%URING_SLOTS];
+
+    if ( sl->state == US_IDLE && uring_submit(uf, sl, URING_CHUNK) < 0 )
+      break;
+  }
+}
+
+
+static ssize_t
+Sread_uring(void *handle, char *buf, size_t size)
+{ uring_file *uf = handle;
+  uring_slot *sl = &uf->slot[uf->next];
+  size_t n;
+
+  if ( sl->state == US_IDLE )
+  { uring_read_ahead(uf);
+    if ( sl->state == US_IDLE )
+      return -1;
+  }
+  if ( sl->state == US_BUSY && uring_wait(uf, sl) < 0 )
+    return -1;
+
+  if ( sl->result < 0 )			/* failed: restart from here */
+  { int err = (int)-sl->result;
+
+    uf->offset = sl->offset;
+    uring_drain(uf);
+    errno = err;
+    return -1;
+  }
+
+  n = (size_t)sl->result - sl->here;
+  if ( n > size )
+    n = size;
+  memcpy(buf, sl->data+sl->here, n);
+  sl->here += n;
+
+  if ( sl->here == (size_t)sl->result )	/* chunk consumed */
+  { if ( (size_t)sl->result < sl->size ) /* short read: read-ahead is wrong */
+    { uf->offset = sl->offset + sl->result;
+      uring_drain(uf);
+    } else
+    { sl->state = US_IDLE;
+      uf->next = (uf->next+1)%URING_SLOTS;
+      uring_read_ahead(uf);
+    }
+  }
+
+  return n;
+}
+
+
+static ssize_t
+Swrite_uring(void *handle, char *buf, size_t size)
+{ uring_file *uf = handle;
+  uring_slot *sl = &uf->slot[uf->next];
+
+  if ( uring_write_done(uf, sl) < 0 )
+    return -1;
+
+  if ( size > URING_CHUNK )
+    size = URING_CHUNK;
+  memcpy(sl->data, buf, size);
+  if ( uring_submit(uf, sl, size) < 0 )
+    return -1;
+  uf->next = (uf->next+1)%URING_SLOTS;
+
+  return size;
+}
+
+
+static int64_t
+Sseek_uring64(void *handle, int64_t pos, int whence)
+{ uring_file *uf = handle;
+  int64_t here = uring_tell(uf);
+
+  if ( uring_drain(uf) < 0 )
+    return -1;
+
+  switch(whence)
+  { case SIO_SEEK_SET:
+      break;
+    case SIO_SEEK_CUR:
+      pos += here;
+      break;
+    case SIO_SEEK_END:
+    { struct stat st;
+
+      if ( fstat(uf->fd, &st) != 0 )
+	return -1;
+      pos += st.st_size;
+      break;
+    }
+    default:
+      errno = EINVAL;
+      return -1;
+  }
+
+  if ( pos < 0 )
+  { errno = EINVAL;
+    return -1;
+  }
+
+  uf->offset = pos;
+  return pos;
+}
+
+
+static long
+Sseek_uring(void *handle, long pos, int whence)
+{ int64_t rc = Sseek_uring64(handle, pos, whence);
+
+  if ( rc > LONG_MAX )
+  { errno = EINVAL;
+    return -1;
+  }
+
+  return (long)rc;
+}
+
+
+static int
+Sclose_uring(void *handle)
+{ uring_file *uf = handle;
+  int rc = uring_drain(uf);
+
+  if ( Sclose_file((void *)(intptr_t)uf->fd) < 0 )
+    rc = -1;
+  uring_free(uf);
+
+  return rc;
+}
+
+
+static int
+Scontrol_uring(void *handle, int action, void *arg)
+{ uring_file *uf = handle;
+
+  switch(action)
+  { case SIO_FLUSHOUTPUT:
+      return uf->output ? uring_drain(uf) : 0;
+    default:
+      return Scontrol_file((void *)(intptr_t)uf->fd, action, arg);
+  }
+}
+
+
+IOFUNCTIONS Suringfunctions =
+{ Sread_uring,
+  Swrite_uring,
+  Sseek_uring,
+  Sclose_uring,
+  Scontrol_uring,
+  Sseek_uring64
+};
+
+#endif /*O_IO_URING*/
+
+
+		 /*******************************
+		 *	   MAPPED FILES		*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Smapfunctions read a regular file that is mapped into memory as a whole.
+The mapping *is* the stream buffer (SIO_USERBUF), so the reader, Sgetcode()
+and read_pending_codes/3 work directly on the mapped pages rather than
+copying the file into a buffer using read().  As the buffer holds the
+entire file, the read function is only called at end of file.  Seeking
+re-establishes the buffer window over the mapping.  If the buffer is
+replaced, e.g. by set_stream/2 using buffer_size(Size), the read and
+seek functions act as a normal file on top of the mapping.
+
+We use a private writable mapping, so Sungetc() can write into the
+buffer.  Note that truncating a mapped file from another process causes
+SIGBUS when accessing the lost pages, which is why mapping is on demand.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+#define O_MAPPED_FILES 1
+
+#ifndef MAP_FAILED
+#define MAP_FAILED ((void *)-1)
+#endif
+
+typedef struct mapped_file
+{ int		fd;			/* the file */
+  char	       *map;			/* start of the mapping */
+  size_t	size;			/* size of the mapping */
+  size_t	here;			/* file offset of next read */
+  IOSTREAM     *stream;			/* stream using the mapping */
+} mapped_file;
+
+
+static mapped_file *
+map_file(int fd)
+{ struct stat buf;
+  mapped_file *mf;
+  void *map;
+
+  if ( fstat(fd, &buf) != 0 ||
+       !S_ISREG(buf.st_mode) ||
+       buf.st_size == 0 ||
+       (uint64_t)buf.st_size > (uint64_t)INT_MAX )	/* s->bufsize is int */
+    return NULL;
+
+  map = mmap(NULL, (size_t)buf.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE,
+	     fd, 0);
+  if ( map == MAP_FAILED )
+    return NULL;
+#ifdef MADV_SEQUENTIAL
+  madvise(map, (size_t)buf.st_size, MADV_SEQUENTIAL);
+#endif
+
+  if ( !(mf = malloc(sizeof(*mf))) )
+  { munmap(map, (size_t)buf.st_size);
+    return NULL;
+  }
+  mf->fd     = fd;
+  mf->map    = map;
+  mf->size   = (size_t)buf.st_size;
+  mf->here   = mf->size;		/* all data is in the buffer */
+  mf->stream = NULL;
+
+  return mf;
+}
+
+
+static ssize_t
+Sread_mapped(void *handle, char *buf, size_t size)
+{ mapped_file *mf = handle;
+  size_t n = mf->size - mf->here;
+
+  if ( n > size )
+    n = size;
+  if ( buf != mf->map + mf->here )
+    memmove(buf, mf->map + mf->here, n);
+  mf->here += n;
+
+  return n;
+}
+
+
+static int64_t
+Sseek_mapped64(void *handle, int64_t pos, int whence)
+{ mapped_file *mf = handle;
+  IOSTREAM *s = mf->stream;
+
+  switch(whence)
+  { case SIO_SEEK_SET:
+      break;
+    case SIO_SEEK_CUR:
+      pos += mf->here;
+      break;
+    case SIO_SEEK_END:
+      pos += mf->size;
+      break;
+    default:
+      errno = EINVAL;
+      return -1;
+  }
+  if ( pos < 0 )
+  { errno = EINVAL;
+    return -1;
+  }
+
+  if ( s && s->buffer == mf->map &&	/* the mapping is the buffer and */
+       s->bufp == s->buffer &&		/* Sseek64() discarded it */
+       s->limitp == s->buffer )
+  { size_t off = (uint64_t)pos > mf->size ? mf->size : (size_t)pos;
+
+    s->bufp   = mf->map + off;
+    s->limitp = mf->map + mf->size;
+    mf->here  = mf->size;
+  } else
+  { mf->here = (uint64_t)pos > mf->size ? mf->size : (size_t)pos;
+  }
+
+  return pos;
+}
+
+
+static long
+Sseek_mapped(void *handle, long pos, int whence)
+{ int64_t rc = Sseek_mapped64(handle, pos, whence);
+
+  if ( rc > LONG_MAX )
+  { errno = EINVAL;
+    return -1;
+  }
+
+  return (long)rc;
+}
+
+
+static int
+Sclose_mapped(void *handle)
+{ mapped_file *mf = handle;
+  int rc;
+
+  munmap(mf->map, mf->size);
+  rc = Sclose_file((void *)(intptr_t)mf->fd);
+  free(mf);
+
+  return rc;
+}
+
+
+static int
+Scontrol_mapped(void *handle, int action, void *arg)
+{ mapped_file *mf = handle;
+
+  switch(action)
+  { case SIO_GETSIZE:
+    { int64_t *rval = arg;
+
+      *rval = mf->size;
+      return 0;
+    }
+    default:
+      return Scontrol_file((void *)(intptr_t)mf->fd, action, arg);
+  }
+}
+
+
+IOFUNCTIONS Smapfunctions =
+{ Sread_mapped,
+  NULL,
+  Sseek_mapped,
+  Sclose_mapped,
+  Scontrol_mapped,
+  Sseek_mapped64
+};
+
+#endif /*HAVE_MMAP*/
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 For now, we use PL_malloc_uncollectable(). In   the  end, this is really
 one of the object-types we want to leave to GC.
@@ -3096,6 +4580,8 @@ after the [rw] argument:
   - "L[rw]" -- use a read or write lock and raise an exception if we
 	       must wait
   - mOOO -- when creating the file, use 0OOO as mode.
+  - "A" -- use asynchronous I/O (io_uring) if available
+  - "M" -- map a regular file for reading into memory if possible
 
 Note that the low-level open  is  always   binary  as  O_TEXT open files
 result in lost and corrupted data in   some  encodings (UTF-16 is one of
@@ -3107,13 +4593,15 @@ IOSTREAM *
 Sopen_file(const char *path, const char *how)
 { int fd;
   int oflags = O_BINARY;
-  int flags = SIO_FILE|SIO_TEXT|SIO_RECORDPOS|SIO_FBUF;
+  int flags = SIO_FILE|SIO_TEXT|SIO_RECORDPOS|SIO_FBUF|SIO_ADAPTIVE;
   int op = *how++;
   intptr_t lfd;
   enum {lnone=0,lread,lwrite} lock = lnone;
   IOSTREAM *s;
   IOENC enc = ENC_UNKNOWN;
   int wait = TRUE;
+  int async = FALSE;
+  int mapped = FALSE;
   int mode = 0666;
 
   for( ; *how; how++)
@@ -3138,6 +4626,12 @@ Sopen_file(const char *path, const char *how)
 	  return NULL;
 	}
         break;
+      case 'A':				/* asynchronous */
+	async = TRUE;
+        break;
+      case 'M':				/* memory mapped */
+	mapped = TRUE;
+        break;
       case 'm':
 	if ( get_mode(how+1, &mode) )
 	{ how += 3;
@@ -3236,7 +4730,37 @@ Sopen_file(const char *path, const char *how)
   }
 
   lfd = (intptr_t)fd;
-  s = Snew((void *)lfd, flags, &Sfilefunctions);
+  s = NULL;
+#ifdef O_MAPPED_FILES
+  { mapped_file *mf;
+
+    if ( mapped && (flags&SIO_INPUT) && (mf=map_file(fd)) )
+    { if ( (s = Snew(mf, (flags&~SIO_FILE)|SIO_USERBUF, &Smapfunctions)) )
+      { s->unbuffer = s->buffer = s->bufp = mf->map;
+	s->limitp   = mf->map + mf->size;
+	s->bufsize  = (int)mf->size;
+	mf->stream  = s;
+      } else
+      { munmap(mf->map, mf->size);
+	free(mf);
+      }
+    }
+  }
+#else
+  (void)mapped;
+#endif
+#ifdef O_IO_URING
+  if ( !s && async )
+  { uring_file *uf;
+
+    if ( (uf=uring_create(fd, flags)) )	/* handle is not a fd */
+      s = Snew(uf, flags&~SIO_FILE, &Suringfunctions);
+  }
+#else
+  (void)async;
+#endif
+  if ( !s )
+    s = Snew((void *)lfd, flags, &Sfilefunctions);
   if ( enc != ENC_UNKNOWN )
     s->encoding = enc;
   if ( lock )
@@ -3276,6 +4800,31 @@ Sfdopen(int fd, const char *type)
   return Snew((void *)lfd, flags, &Sfilefunctions);
 }
 
+/* Sisasync() is true if s uses the asynchronous file backend selected
+   by the open/4 option async(true).  Sismapped() is true if s reads
+   from a mapping of the file as selected by the option mmap(true).
+*/
+
+int
+Sisasync(IOSTREAM *s)
+{
+#ifdef O_IO_URING
+  return s->functions == &Suringfunctions;
+#else
+  return FALSE;
+#endif
+}
+
+int
+Sismapped(IOSTREAM *s)
+{
+#ifdef O_MAPPED_FILES
+  return s->functions == &Smapfunctions;
+#else
+  return FALSE;
+#endif
+}
+
 /* MT: as long as s is valid, this should be ok
 */
 
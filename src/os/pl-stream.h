@@ -51,6 +51,9 @@
 #define ATOMIC_DEC(ptr)			(--(*ptr))
 #endif
 
+int Sisasync(IOSTREAM *s);
+int Sismapped(IOSTREAM *s);
+
 
 #ifdef O_DEBUG_STREAM_REFERENCES
 
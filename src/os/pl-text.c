@@ -42,6 +42,12 @@
 #if HAVE_LIMITS_H
 #include <limits.h>			/* solaris compatibility */
 #endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#if SIZEOF_WCHAR_T == 4
+#define O_WIDE_SSE2 1
+#endif
+#endif
 
 #undef LD
 #define LD LOCAL_LD
@@ -1303,6 +1309,269 @@ PL_cmp_text(PL_chars_t *t1, size_t o1, PL_chars_t *t2, size_t o2,
 }
 
 
+		 /*******************************
+		 *	   TEXT SCANNING	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+A char_set represents a set of characters for split_string/4 and friends.
+Membership is the same as text_chr() != -1, which means the terminating
+0 is a member and characters after an embedded 0 are not.  If the set is
+small, text_find_set() compares 16 bytes or 4 wide characters at a time
+against each member using SSE2.  Otherwise it uses a lookup table.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+init_char_set(char_set *cs, const PL_chars_t *text)
+{ size_t i;
+
+  memset(cs->member, 0, sizeof(cs->member));
+  cs->text   = text;
+  cs->nlatin = 0;
+  cs->nwide  = 0;
+
+  for(i=0; ; i++)
+  { int c = i < text->length ? text_get_char(text, i) : 0;
+
+    if ( c <= 0xff )
+    { if ( cs->member[c] )
+	goto next;
+      cs->member[c] = TRUE;
+      if ( cs->nlatin >= 0 )
+      { if ( cs->nlatin < CHAR_SET_VECTOR )
+	  cs->latin[cs->nlatin++] = c;
+	else
+	  cs->nlatin = -1;
+      }
+    }
+    if ( cs->nwide >= 0 )
+    { if ( cs->nwide < CHAR_SET_VECTOR )
+	cs->wide[cs->nwide++] = c;
+      else
+	cs->nwide = -1;
+    }
+  next:
+    if ( c == 0 )
+      break;
+  }
+}
+
+
+static size_t
+latin_find_set(const unsigned char *s, size_t from, size_t to,
+	       const char_set *cs, int in)
+{ const unsigned char *p = s+from;
+  const unsigned char *e = s+to;
+
+#ifdef __SSE2__
+  if ( cs->nlatin > 0 && e-p >= 16 )
+  { __m128i v[CHAR_SET_VECTOR];
+    int i, n = cs->nlatin;
+
+    for(i=0; i<n; i++)
+      v[i] = _mm_set1_epi8((char)cs->latin[i]);
+
+    while( e-p >= 16 )
+    { __m128i d = _mm_loadu_si128((const __m128i*)p);
+      __m128i m = _mm_cmpeq_epi8(d, v[0]);
+      int mask;
+
+      for(i=1; i<n; i++)
+	m = _mm_or_si128(m, _mm_cmpeq_epi8(d, v[i]));
+      mask = _mm_movemask_epi8(m);
+      if ( !in )
+	mask ^= 0xffff;
+      if ( mask )
+	return (p-s) + __builtin_ctz(mask);
+      p += 16;
+    }
+  }
+#endif
+
+  for( ; p < e; p++ )
+  { if ( cs->member[*p] == in )
+      break;
+  }
+
+  return p-s;
+}
+
+
+static inline int
+wide_member(const char_set *cs, int c)
+{ if ( c <= 0xff )
+    return cs->member[c];
+  if ( cs->nwide >= 0 )
+  { int i;
+
+    for(i=0; i<cs->nwide; i++)
+    { if ( cs->wide[i] == c )
+	return TRUE;
+    }
+    return FALSE;
+  }
+
+  return text_chr(cs->text, c) != (size_t)-1;
+}
+
+
+static size_t
+wide_find_set(const pl_wchar_t *s, size_t from, size_t to,
+	      const char_set *cs, int in)
+{ const pl_wchar_t *p = s+from;
+  const pl_wchar_t *e = s+to;
+
+#ifdef O_WIDE_SSE2
+  if ( cs->nwide > 0 && e-p >= 4 )
+  { __m128i v[CHAR_SET_VECTOR];
+    int i, n = cs->nwide;
+
+    for(i=0; i<n; i++)
+      v[i] = _mm_set1_epi32(cs->wide[i]);
+
+    while( e-p >= 4 )
+    { __m128i d = _mm_loadu_si128((const __m128i*)p);
+      __m128i m = _mm_cmpeq_epi32(d, v[0]);
+      int mask;
+
+      for(i=1; i<n; i++)
+	m = _mm_or_si128(m, _mm_cmpeq_epi32(d, v[i]));
+      mask = _mm_movemask_epi8(m);
+      if ( !in )
+	mask ^= 0xffff;
+      if ( mask )
+	return (p-s) + __builtin_ctz(mask)/4;
+      p += 4;
+    }
+  }
+#endif
+
+  for( ; p < e; p++ )
+  { if ( wide_member(cs, *p) == in )
+      break;
+  }
+
+  return p-s;
+}
+
+
+/* text_find_set() returns the index of the first character in [from,to)
+   that is (in is TRUE) or is not (in is FALSE) a member of cs, or `to'
+   if there is no such character.
+*/
+
+size_t
+text_find_set(const PL_chars_t *t, size_t from, size_t to,
+	      const char_set *cs, int in)
+{ in = !!in;
+
+  if ( t->encoding == ENC_ISO_LATIN_1 )
+    return latin_find_set((const unsigned char *)t->text.t, from, to, cs, in);
+  else
+    return wide_find_set(t->text.w, from, to, cs, in);
+}
+
+
+/* text_back_skip_set() returns the lowest index i >= from such that all
+   characters in [i,to) are members of cs.  Padding is normally short,
+   so this is not vectorised.
+*/
+
+size_t
+text_back_skip_set(const PL_chars_t *t, size_t from, size_t to,
+		   const char_set *cs)
+{ if ( t->encoding == ENC_ISO_LATIN_1 )
+  { const unsigned char *s = (const unsigned char *)t->text.t;
+
+    while( to > from && cs->member[s[to-1]] )
+      to--;
+  } else
+  { const pl_wchar_t *s = t->text.w;
+
+    while( to > from && wide_member(cs, s[to-1]) )
+      to--;
+  }
+
+  return to;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+text_search() returns the index of the first occurrence of sub in t at
+or after from, or (size_t)-1.  For ISO Latin-1 text, SSE2 is used to
+find the positions where both the first and last character of sub match.
+Only those positions are compared in full.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static size_t
+latin_search(const unsigned char *s, size_t len, size_t from,
+	     const unsigned char *sub, size_t sublen)
+{ size_t i = from;
+  int first = sub[0];
+
+  if ( sublen == 1 )
+  { const unsigned char *p = memchr(s+from, first, len-from);
+
+    return p ? (size_t)(p-s) : (size_t)-1;
+  }
+
+#ifdef __SSE2__
+  { const __m128i f = _mm_set1_epi8((char)first);
+    const __m128i l = _mm_set1_epi8((char)sub[sublen-1]);
+
+    for( ; i+sublen-1+16 <= len; i += 16 )
+    { __m128i a = _mm_loadu_si128((const __m128i*)(s+i));
+      __m128i b = _mm_loadu_si128((const __m128i*)(s+i+sublen-1));
+      int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, f),
+						 _mm_cmpeq_epi8(b, l)));
+
+      while( mask )
+      { int bit = __builtin_ctz(mask);
+
+	if ( memcmp(s+i+bit+1, sub+1, sublen-2) == 0 )
+	  return i+bit;
+	mask &= mask-1;
+      }
+    }
+  }
+#endif
+
+  for( ; i+sublen <= len; i++ )
+  { if ( s[i] == first && memcmp(s+i+1, sub+1, sublen-1) == 0 )
+      return i;
+  }
+
+  return (size_t)-1;
+}
+
+
+size_t
+text_search(const PL_chars_t *t, size_t from, const PL_chars_t *sub)
+{ size_t len = t->length;
+  size_t sublen = sub->length;
+  size_t i;
+  int first;
+
+  if ( from > len || sublen > len-from )
+    return (size_t)-1;
+  if ( sublen == 0 )
+    return from;
+
+  if ( t->encoding == ENC_ISO_LATIN_1 && sub->encoding == ENC_ISO_LATIN_1 )
+    return latin_search((const unsigned char *)t->text.t, len, from,
+			(const unsigned char *)sub->text.t, sublen);
+
+  first = text_get_char(sub, 0);
+  for(i=from; i+sublen <= len; i++)
+  { if ( text_get_char(t, i) == first &&
+	 PL_cmp_text((PL_chars_t *)t, i, (PL_chars_t *)sub, 0, sublen) == 0 )
+      return i;
+  }
+
+  return (size_t)-1;
+}
+
+
 int
 PL_concat_text(int n, PL_chars_t **text, PL_chars_t *result)
 { size_t total_length = 0;
@@ -78,6 +78,25 @@ int	PL_cmp_text(PL_chars_t *t1, size_t o1, PL_chars_t *t2, size_t o2,
 		    size_t len);
 int	PL_concat_text(int n, PL_chars_t **text, PL_chars_t *result);
 
+#define CHAR_SET_VECTOR 8		/* max chars tested in parallel */
+
+typedef struct
+{ const PL_chars_t *text;		/* the set as text */
+  int		nlatin;			/* # chars in latin[] or -1 */
+  int		nwide;			/* # chars in wide[] or -1 */
+  unsigned char	latin[CHAR_SET_VECTOR];	/* members <= 0xff */
+  int		wide[CHAR_SET_VECTOR];	/* all members */
+  unsigned char	member[256];		/* membership of chars <= 0xff */
+} char_set;
+
+COMMON(void)	init_char_set(char_set *cs, const PL_chars_t *text);
+COMMON(size_t)	text_find_set(const PL_chars_t *t, size_t from, size_t to,
+			      const char_set *cs, int in);
+COMMON(size_t)	text_back_skip_set(const PL_chars_t *t, size_t from, size_t to,
+				   const char_set *cs);
+COMMON(size_t)	text_search(const PL_chars_t *t, size_t from,
+			    const PL_chars_t *sub);
+
 void	PL_free_text(PL_chars_t *text);
 void	PL_save_text(PL_chars_t *text, int flags);
 
@@ -120,4 +139,13 @@ text_chr(const PL_chars_t *t, int chr)
 }
 
 
+static inline int
+char_set_member(const char_set *cs, int chr)
+{ if ( chr <= 0xff )
+    return cs->member[chr];
+
+  return text_chr(cs->text, chr) != (size_t)-1;
+}
+
+
 #endif /*PL_TEXT_H_INCLUDED*/
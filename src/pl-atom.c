@@ -602,6 +602,7 @@ redo:
   { a->name = (char *)s;
   }
 
+  a->write_flags = 0;
 #ifdef O_TERMHASH
   a->hash_value = v0;
 #endif
@@ -1531,6 +1532,7 @@ registerBuiltinAtoms(void)
     a->name       = (char *)s;
     a->length     = len;
     a->type       = &text_atom;
+    a->write_flags = 0;
 #ifdef O_ATOMGC
     a->references = ATOM_VALID_REFERENCE | ATOM_RESERVED_REFERENCE;
 #endif
@@ -0,0 +1,509 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "pl-incl.h"
+#include "os/pl-utf8.h"
+#include <wctype.h>
+
+#undef LD
+#define LD LOCAL_LD
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Support for library(csv).  '$csv_read_row'/4 reads a single CSV record
+from a stream and builds the row term directly.  It follows the
+grammar of csv//2:
+
+  - A field that starts with a double quote extends up to the next quote
+    that is not doubled and must be followed by a separator or the end
+    of the record.
+  - Other fields extend up to the next separator or end of record.  If
+    `strip' is set, leading and trailing spaces and tabs are removed.
+  - A record ends with \n, \r\n, \r or the end of the input.
+
+Field text is collected as UTF-8.  Runs of ordinary characters are taken
+from the stream buffer using Sread_text().  Other characters are read
+using Sgetcode().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define CSV_SEP	  0			/* field ended in separator */
+#define CSV_EOR	  1			/* field ended the record */
+#define CSV_ERROR (-1)			/* syntax or I/O error */
+
+typedef struct csv_options
+{ int		separator;		/* field separator */
+  int		strip;			/* strip blank space */
+  int		ignore_quotes;		/* " is a normal character */
+  int		convert;		/* convert to numbers */
+  int		case_action;		/* -1: down, 0: preserve, 1: up */
+  atom_t	functor;		/* name of the row */
+  int		lines;			/* line based: \r\n in quotes is \n */
+  int		runs;			/* use Sread_text() */
+  unsigned char	stop[16];		/* stop set for plain fields */
+  unsigned char	qstop[16];		/* stop set for quoted fields */
+} csv_options;
+
+#define addStop(set, c) ((set)[(c)>>3] |= 1<<((c)&7))
+
+/* Options are the record term created by library(csv):
+   csv_options(Separator, Strip, IgnoreQuotes, Convert, Case, Functor, ...)
+*/
+
+static int
+get_csv_options(term_t t, csv_options *opts ARG_LD)
+{ term_t a = PL_new_term_ref();
+  atom_t case_action;
+
+  if ( !PL_is_functor(t, FUNCTOR_csv_options9) )
+    return PL_type_error("csv_options", t);
+
+  if ( !PL_get_arg(1, t, a) || !PL_get_char_ex(a, &opts->separator, FALSE) ||
+       !PL_get_arg(2, t, a) || !PL_get_bool_ex(a, &opts->strip) ||
+       !PL_get_arg(3, t, a) || !PL_get_bool_ex(a, &opts->ignore_quotes) ||
+       !PL_get_arg(4, t, a) || !PL_get_bool_ex(a, &opts->convert) ||
+       !PL_get_arg(5, t, a) || !PL_get_atom_ex(a, &case_action) ||
+       !PL_get_arg(6, t, a) || !PL_get_atom_ex(a, &opts->functor) )
+    return FALSE;
+
+  if ( case_action == ATOM_down )
+    opts->case_action = -1;
+  else if ( case_action == ATOM_preserve )
+    opts->case_action = 0;
+  else if ( case_action == ATOM_up )
+    opts->case_action = 1;
+  else
+  { _PL_get_arg(5, t, a);
+    return PL_domain_error("case", a);
+  }
+
+  memset(opts->stop,  0, sizeof(opts->stop));
+  memset(opts->qstop, 0, sizeof(opts->qstop));
+  if ( (opts->runs = (opts->separator < 128)) )
+  { addStop(opts->stop, opts->separator);
+    addStop(opts->stop, '\n');
+    addStop(opts->stop, '\r');
+    addStop(opts->qstop, '"');
+    addStop(opts->qstop, '\r');
+  }
+
+  return TRUE;
+}
+
+
+static void
+add_code(Buffer b, int c)
+{ if ( c < 0x80 )
+  { addBuffer(b, (char)c, char);
+  } else
+  { char tmp[6];
+    char *e = utf8_put_char(tmp, c);
+
+    addMultipleBuffer(b, tmp, e-tmp, char);
+  }
+}
+
+
+static void
+add_run(IOSTREAM *s, Buffer b, const unsigned char *stop)
+{ size_t avail = s->limitp - s->bufp;
+
+  if ( avail > 0 && growBuffer(b, avail*2) )
+  { size_t chars = (size_t)-1;
+
+    b->top += Sread_text(s, b->top, freeSpaceBuffer(b), &chars, stop);
+  }
+}
+
+
+/* end_of_field() processes the character after a field */
+
+static int
+end_of_field(IOSTREAM *s, int c, csv_options *opts)
+{ if ( c == opts->separator )
+    return CSV_SEP;
+  if ( c == '\n' )
+    return CSV_EOR;
+  if ( c == '\r' )
+  { if ( Speekcode(s) == '\n' )
+      Sgetcode(s);
+    return CSV_EOR;
+  }
+  if ( c == EOF )
+    return Sferror(s) ? CSV_ERROR : CSV_EOR;
+
+  return CSV_ERROR;
+}
+
+
+static int
+read_field(IOSTREAM *s, Buffer b, csv_options *opts)
+{ int c = Sgetcode(s);
+
+  emptyBuffer(b);
+
+  if ( c == '"' && !opts->ignore_quotes )
+  { for(;;)
+    { if ( opts->runs )
+	add_run(s, b, opts->qstop);
+      if ( (c = Sgetcode(s)) == EOF )
+	return CSV_ERROR;
+      if ( c == '"' )
+      { if ( Speekcode(s) != '"' )
+	  break;
+	Sgetcode(s);
+      } else if ( c == '\r' && opts->lines && Speekcode(s) == '\n' )
+      { c = Sgetcode(s);
+      }
+      add_code(b, c);
+    }
+
+    return end_of_field(s, Sgetcode(s), opts);
+  }
+
+  if ( opts->strip )
+  { while( c == ' ' || c == '\t' )
+      c = Sgetcode(s);
+  }
+
+  for(;;)
+  { if ( c == opts->separator || c == '\n' || c == '\r' || c == EOF )
+    { if ( opts->strip )
+      { while( b->top > b->base && (b->top[-1] == ' ' || b->top[-1] == '\t') )
+	  b->top--;
+      }
+      return end_of_field(s, c, opts);
+    }
+    add_code(b, c);
+    if ( opts->runs )
+      add_run(s, b, opts->stop);
+    c = Sgetcode(s);
+  }
+}
+
+
+/* put_value() converts the UTF-8 field text in b to an atom or number.
+   Number conversion uses str_number() on the ISO Latin-1 text, as
+   name/2 and number_string/2 do.
+*/
+
+static int
+put_value(term_t t, Buffer b, csv_options *opts ARG_LD)
+{ const char *s = baseBuffer(b, char);
+  size_t len = entriesBuffer(b, char);
+  size_t i;
+  int latin = TRUE, ascii = TRUE;
+
+  for(i=0; i<len; i++)
+  { if ( s[i] & 0x80 )
+    { ascii = FALSE;
+      break;
+    }
+  }
+
+  if ( !ascii )
+  { const char *q, *e = s+len;
+    char *o = (char*)s;			/* decode in place: shorter */
+
+    for(q=s; q<e; )
+    { int c;
+
+      q = utf8_get_char(q, &c);
+      if ( c > 0xff )
+      { latin = FALSE;
+	break;
+      }
+    }
+    if ( latin )
+    { for(q=s; q<e; )
+      { int c;
+
+	q = utf8_get_char(q, &c);
+	*o++ = (char)c;
+      }
+      b->top = o;
+      len = o-s;
+    }
+  }
+
+  if ( opts->convert && latin )
+  { unsigned char *q;
+    strnumstat rc;
+    number n;
+    AR_CTX;
+
+    addBuffer(b, EOS, char);
+    AR_BEGIN();
+    rc = str_number((const unsigned char *)s, &q, &n, FALSE);
+    if ( rc == NUM_OK && *q == EOS )
+    { int rc2 = PL_put_number(t, &n);
+
+      clearNumber(&n);
+      AR_END();
+      return rc2;
+    }
+    if ( rc == NUM_OK )
+      clearNumber(&n);
+    AR_END();
+  }
+
+  if ( opts->case_action == 0 )
+  { return PL_put_chars(t, PL_ATOM|(latin ? REP_ISO_LATIN_1 : REP_UTF8),
+			len, s);
+  } else
+  { tmp_buffer wb;
+    const char *q, *e = s+len;
+    int rc;
+
+    initBuffer(&wb);
+    for(q=s; q<e; )
+    { int c;
+
+      if ( latin )
+	c = *q++ & 0xff;
+      else
+	q = utf8_get_char(q, &c);
+      c = opts->case_action < 0 ? towlower(c) : towupper(c);
+      addBuffer(&wb, (pl_wchar_t)c, pl_wchar_t);
+    }
+    PL_put_variable(t);
+    rc = PL_unify_wchars(t, PL_ATOM,
+			 entriesBuffer(&wb, pl_wchar_t),
+			 baseBuffer(&wb, pl_wchar_t));
+    discardBuffer(&wb);
+
+    return rc;
+  }
+}
+
+
+/** '$csv_read_row'(+Stream, -Row, +Options, +Lines)
+ *
+ * Read the next record from Stream.  Row is unified with `end_of_file`
+ * if the stream is at its end.  Fails on a syntax error.
+ */
+
+static
+PRED_IMPL("$csv_read_row", 4, csv_read_row, 0)
+{ PRED_LD
+  IOSTREAM *s;
+  csv_options opts;
+  tmp_buffer field, values;
+  int rc = FALSE;
+
+  if ( !get_csv_options(A3, &opts PASS_LD) ||
+       !PL_get_bool_ex(A4, &opts.lines) ||
+       !getTextInputStream(A1, &s) )
+    return FALSE;
+
+  initBuffer(&field);
+  initBuffer(&values);
+
+  if ( Speekcode(s) == EOF )
+  { if ( !Sferror(s) )
+      rc = PL_unify_atom(A2, ATOM_end_of_file);
+  } else
+  { term_t av, row;
+    size_t i, n;
+    int end;
+
+    do
+    { term_t v;
+
+      if ( (end = read_field(s, (Buffer)&field, &opts)) == CSV_ERROR ||
+	   !(v = PL_new_term_ref()) ||
+	   !put_value(v, (Buffer)&field, &opts PASS_LD) )
+	goto out;
+      addBuffer(&values, v, term_t);
+    } while(end == CSV_SEP);
+
+    n = entriesBuffer(&values, term_t);
+    if ( !(av = PL_new_term_refs(n)) ||
+	 !(row = PL_new_term_ref()) )
+      goto out;
+    for(i=0; i<n; i++)
+      PL_put_term(av+i, fetchBuffer(&values, i, term_t));
+    rc = ( PL_cons_functor_v(row, PL_new_functor(opts.functor, n), av) &&
+	   PL_unify(A2, row) );
+  }
+
+out:
+  discardBuffer(&field);
+  discardBuffer(&values);
+  if ( rc )
+    rc = PL_release_stream(s);
+  else
+    PL_release_stream(s);
+
+  return rc;
+}
+
+
+		 /*******************************
+		 *	      CHUNKS		*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+'$csv_chunks'(+Stream, +Options, +Size, -Chunks) scans the remainder of
+Stream and splits it into chunks of at least Size bytes that start at
+a record boundary.  Chunks is a list chunk(Offset, Rows), where Offset
+is the byte offset of the first record and Rows is the number of records
+in the chunk.  This allows library(csv) to parse the chunks concurrently
+by seeking to Offset and reading Rows records.
+
+Only the record structure is established: quoted fields are skipped and
+no values are created.  The scan is done on bytes and is valid if the
+separator is ASCII and the encoding is ASCII compatible, i.e., octet,
+ascii, iso_latin_1 or utf8.  Fails on a syntax error.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+skip_cr_lf(IOSTREAM *s)
+{ int c = Sgetc(s);
+
+  if ( c == '\n' )
+    return 1;
+  if ( c != EOF )
+    Sungetc(c, s);
+  return 0;
+}
+
+
+static int
+add_chunk(term_t tail, int64_t start, int64_t rows ARG_LD)
+{ term_t head = PL_new_term_ref();
+
+  return ( PL_unify_list(tail, head, tail) &&
+	   PL_unify_term(head, PL_FUNCTOR, FUNCTOR_chunk2,
+				 PL_INT64, start,
+				 PL_INT64, rows) );
+}
+
+
+static
+PRED_IMPL("$csv_chunks", 4, csv_chunks, 0)
+{ PRED_LD
+  IOSTREAM *s;
+  csv_options opts;
+  int64_t size, here, start, rows = 0;
+  term_t tail = PL_copy_term_ref(A4);
+  int rc = FALSE;
+
+  if ( !get_csv_options(A2, &opts PASS_LD) ||
+       !PL_get_int64_ex(A3, &size) )
+    return FALSE;
+  if ( opts.separator >= 128 )
+    return PL_domain_error("ascii_separator", A2);
+  if ( !getTextInputStream(A1, &s) )
+    return FALSE;
+
+  if ( (here = Stell64(s)) < 0 )
+    goto out;
+  start = here;
+
+  for(;;)
+  { int c = Sgetc(s);			/* start of a record */
+
+    if ( c == EOF )
+      break;
+    here++;
+
+    for(;;)				/* field loop */
+    { if ( c == '"' && !opts.ignore_quotes )
+      { for(;;)
+	{ if ( (c = Sgetc(s)) == EOF )
+	    goto out;			/* unterminated quoted field */
+	  here++;
+	  if ( c == '"' )
+	  { if ( (c = Sgetc(s)) != '"' )
+	      break;
+	    here++;
+	  }
+	}
+	if ( c == EOF )
+	  break;
+	here++;
+	if ( c != opts.separator && c != '\n' && c != '\r' )
+	  goto out;
+      } else
+      { while( c != opts.separator && c != '\n' && c != '\r' )
+	{ if ( (c = Sgetc(s)) == EOF )
+	    break;
+	  here++;
+	}
+      }
+
+      if ( c == opts.separator )
+      { if ( (c = Sgetc(s)) == EOF )
+	  break;
+	here++;
+	continue;
+      }
+      if ( c == '\r' )
+	here += skip_cr_lf(s);
+      break;				/* end of record */
+    }
+
+    rows++;
+    if ( here - start >= size )
+    { if ( !add_chunk(tail, start, rows PASS_LD) )
+	goto out;
+      start = here;
+      rows = 0;
+    }
+    if ( c == EOF )
+      break;
+  }
+
+  if ( Sferror(s) )
+    goto out;
+  rc = ( (rows == 0 || add_chunk(tail, start, rows PASS_LD)) &&
+	 PL_unify_nil(tail) );
+
+out:
+  if ( rc )
+    rc = PL_release_stream(s);
+  else
+    PL_release_stream(s);
+
+  return rc;
+}
+
+
+		 /*******************************
+		 *      PUBLISH PREDICATES	*
+		 *******************************/
+
+BeginPredDefs(csv)
+  PRED_DEF("$csv_read_row", 4, csv_read_row, 0)
+  PRED_DEF("$csv_chunks", 4, csv_chunks, 0)
+EndPredDefs
@@ -350,6 +350,7 @@ DECL_PLIST(list);
 DECL_PLIST(module);
 DECL_PLIST(prims);
 DECL_PLIST(strings);
+DECL_PLIST(csv);
 DECL_PLIST(variant);
 DECL_PLIST(copyterm);
 DECL_PLIST(prologflag);
@@ -412,6 +413,7 @@ initBuildIns(void)
   REG_PLIST(module);
   REG_PLIST(prims);
   REG_PLIST(strings);
+  REG_PLIST(csv);
   REG_PLIST(variant);
   REG_PLIST(copyterm);
   REG_PLIST(prologflag);
@@ -306,6 +306,7 @@ COMMON(word)		pl_current_format_predicate(term_t chr, term_t descr,
 					    control_t h);
 COMMON(word)		pl_format(term_t fmt, term_t args);
 COMMON(word)		pl_format3(term_t s, term_t fmt, term_t args);
+COMMON(void)		freeFormatCache(PL_local_data_t *ld);
 
 /* pl-funct.c */
 COMMON(functor_t)	lookupFunctorDef(atom_t atom, size_t arity);
@@ -606,6 +607,7 @@ COMMON(bool)		unifyKey(term_t key, word val);
 COMMON(int)		getKeyEx(term_t key, word *k ARG_LD);
 COMMON(word)		pl_term_complexity(term_t t, term_t mx, term_t count);
 COMMON(void)		markAtomsRecord(Record record);
+COMMON(void)		freeFastRWDict(struct fastrw_dict *dict);
 
 /* pl-rl.c */
 COMMON(void)		install_rl(void);
@@ -329,6 +329,8 @@ struct PL_global_data
     Procedure	tune_gc3;		/* prolog:tune_gc */
     Procedure	trie_gen_compiled2;
     Procedure	trie_gen_compiled3;
+    Procedure	tbl_answer_update_dl2;	/* $tbl_answer_update_dl/2 */
+    Procedure	tbl_answer_update_dl3;	/* $tbl_answer_update_dl/3 */
 
     int		static_dirty;		/* #static dirty procedures */
 #ifdef O_CLAUSEGC
@@ -459,6 +461,10 @@ struct PL_local_data
     struct wic_state *current_state;	/* qlf-creation state */
   } qlf;
 
+  struct
+  { struct fmt_program **cache;		/* pl-fmt.c: compiled formats */
+  } format;
+
   struct
   { atom_t	current;		/* current global prompt */
     atom_t	first;			/* how to prompt first line */
@@ -596,12 +602,20 @@ struct PL_local_data
   { struct tbl_component *component;    /* active component */
     struct trie *variant_table;		/* Variant --> table */
     trie_allocation_pool node_pool;	/* Node allocation pool for tries */
+    unsigned int compile_threshold;	/* Compile tries after N enumerations */
     int	has_scheduling_component;	/* A leader was created */
     int in_answer_completion;		/* Running answer completion */
     term_t delay_list;			/* Global delay list */
     term_t idg_current;			/* Current node in IDG (trie symbol) */
   } tabling;
 
+  struct
+  { unsigned int accessing;		/* Nesting of trie accesses */
+#ifndef O_PLMT
+    gen_t	generation;		/* Generation of outer access */
+#endif
+  } tries;
+
   struct
   {
 #ifdef __BEOS__
@@ -925,6 +925,7 @@ with one operation, it turns out to be faster as well.
 #define R_DUPLICATE		(0x0004) /* record: include references */
 #define R_NOLOCK		(0x0008) /* record: do not lock atoms */
 #define R_DBREF			(0x0010) /* record: has DB-reference */
+#define R_IMAGE			(0x0020) /* record: has ground stack image */
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Macros for environment frames (local stack frames)
@@ -1133,6 +1134,7 @@ struct atom
   };
   size_t	length;		/* length of the atom */
   char *	name;		/* name associated with atom */
+  unsigned int	write_flags;	/* cached quoting class (pl-write.c) */
 };
 
 
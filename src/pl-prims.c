@@ -4194,15 +4194,11 @@ split_atom(term_t list, PL_chars_t *st, term_t atom ARG_LD)
   if ( !PL_get_text(atom, &at, CVT_ATOMIC|CVT_EXCEPTION) )
     return FALSE;
 
-  for(last=i=0; (ssize_t)i<=(ssize_t)(at.length-sep_len); )
-  { if ( PL_cmp_text(st, 0, &at, i, sep_len) == 0 )
-    { if ( !PL_unify_list(tail, head, tail) ||
-	   !PL_unify_text_range(head, &at, last, i-last, PL_ATOM) )
-	fail;
-      i += sep_len;
-      last = i;
-    } else
-      i++;
+  for(last=0; (i=text_search(&at, last, st)) != (size_t)-1; )
+  { if ( !PL_unify_list(tail, head, tail) ||
+	 !PL_unify_text_range(head, &at, last, i-last, PL_ATOM) )
+      fail;
+    last = i+sep_len;
   }
 
   if ( !PL_unify_list(tail, head, tail) ||
@@ -4642,15 +4638,13 @@ again:
       la = state->n2;
       ls = state->n3;
 
-      for( ; state->n1+ls <= la; state->n1++ )
-      { if ( PL_cmp_text(&ta, state->n1, &ts, 0, ls) == 0 )
-	{ match = (PL_unify_integer(before, state->n1) &&
-		   PL_unify_integer(len,    ls) &&
-		   PL_unify_integer(after,  la-ls-state->n1));
+      if ( (state->n1 = text_search(&ta, state->n1, &ts)) != (size_t)-1 )
+      { match = (PL_unify_integer(before, state->n1) &&
+		 PL_unify_integer(len,    ls) &&
+		 PL_unify_integer(after,  la-ls-state->n1));
 
-	  state->n1++;
-	  goto next;
-	}
+	state->n1++;
+	goto next;
       }
       goto exit_fail;
     }
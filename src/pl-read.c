@@ -42,6 +42,9 @@
 #include "pl-umap.c"			/* Unicode map */
 #include "pl-dict.h"
 #include <errno.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 typedef const unsigned char * cucharp;
 typedef       unsigned char * ucharp;
@@ -408,7 +411,9 @@ typedef struct
 #endif
   bool		cycles;			/* Re-establish cycles */
   bool		dotlists;		/* read .(a,b) as a list */
+  bool		data_only;		/* read without operators */
   int		strictness;		/* Strictness level */
+  bool		ascii_runs;		/* Use scan_ascii_run() */
 
   atom_t	locked;			/* atom that must be unlocked */
 					/* NOT ZEROED BELOW HERE (_rb is first) */
@@ -922,6 +927,109 @@ getchr__(ReadData _PL_rd)
 #define getchr()  getchr__(_PL_rd)
 #define getchrq() Sgetcode(rb.stream)
 
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Most of the input consists of runs of  identifier characters and quoted
+text that need no further attention. If the stream maps ASCII bytes 1:1
+to code points and there is no  character conversion, we copy such runs
+directly from the stream buffer into the read buffer, rather than taking
+the getchr() route for each character. Runs contain no newlines, so the
+position is updated by simply adding the length of the run.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static bool
+can_scan_ascii_runs(ReadData _PL_rd)
+{ IOSTREAM *s = rb.stream;
+
+  if ( _PL_rd->char_conversion_table || s->tee )
+    return FALSE;
+
+  switch(s->encoding)
+  { case ENC_OCTET:
+    case ENC_ASCII:
+    case ENC_ISO_LATIN_1:
+    case ENC_UTF8:
+      return TRUE;
+    case ENC_ANSI:			/* ASCII compatible unless shifted */
+      return !s->mbstate || mbsinit(s->mbstate);
+    default:
+      return FALSE;
+  }
+}
+
+
+static const unsigned char *
+skip_quoted_run(const unsigned char *p, const unsigned char *e, int q)
+{
+#ifdef __SSE2__
+  const __m128i lo  = _mm_set1_epi8(' ');
+  const __m128i del = _mm_set1_epi8(0x7f);
+  const __m128i bsl = _mm_set1_epi8('\\');
+  const __m128i quo = _mm_set1_epi8((char)q);
+
+  while( e-p >= 16 )
+  { __m128i v = _mm_loadu_si128((const __m128i*)p);
+    __m128i stop;				/* signed: >= 0x80 is < ' ' */
+    int mask;
+
+    stop = _mm_or_si128(_mm_cmplt_epi8(v, lo), _mm_cmpeq_epi8(v, del));
+    stop = _mm_or_si128(stop, _mm_cmpeq_epi8(v, bsl));
+    stop = _mm_or_si128(stop, _mm_cmpeq_epi8(v, quo));
+    if ( (mask=_mm_movemask_epi8(stop)) )
+      return p + __builtin_ctz(mask);
+    p += 16;
+  }
+#endif
+
+  while( p < e && *p >= ' ' && *p < 0x7f && *p != '\\' && *p != q )
+    p++;
+
+  return p;
+}
+
+
+static void
+scan_ascii_run(int q, ReadData _PL_rd)
+{ IOSTREAM *s = rb.stream;
+  const unsigned char *start = (const unsigned char *)s->bufp;
+  const unsigned char *e = (const unsigned char *)s->limitp;
+  const unsigned char *p, *c;
+  size_t n;
+
+  if ( q )
+  { p = skip_quoted_run(start, e, q);
+  } else
+  { for(p=start; p < e && *p < 0x80 && _PL_char_types[*p] >= UC; p++)
+      ;
+  }
+
+  if ( (n = p-start) )
+  { IOPOS *pos;
+
+    for(c=start; (size_t)(rb.end - rb.here) < n; c++, n--)
+      addByteToBuffer(*c, _PL_rd);	/* grows the buffer */
+    memcpy(rb.here, c, n);
+    rb.here += n;
+    s->bufp = (char *)p;
+
+    if ( (pos=s->position) )
+    { n = p-start;
+      pos->byteno  += n;
+      pos->charno  += n;
+      pos->linepos += (int)n;
+    }
+  }
+}
+
+
+static inline int
+getchrq_run(int q, ReadData _PL_rd)
+{ if ( _PL_rd->ascii_runs )
+    scan_ascii_run(q, _PL_rd);
+
+  return getchrq();
+}
+
 #define ensure_space(c) { if ( something_read && \
 			       (c == '\n' || !isBlank(rb.here[-1])) ) \
 			   addToBuffer(c, _PL_rd); \
@@ -964,7 +1072,7 @@ raw_read_quoted(int q, ReadData _PL_rd)
     pos = NULL;
 
   addToBuffer(q, _PL_rd);
-  while((c=getchrq()) != EOF && c != q)
+  while((c=getchrq_run(q, _PL_rd)) != EOF && c != q)
   {
   next:
     if ( c == '\\' && true(_PL_rd, M_CHARESCAPE) )
@@ -1068,6 +1176,8 @@ static int
 raw_read_identifier(int c, ReadData _PL_rd)
 { do
   { addToBuffer(c, _PL_rd);
+    if ( _PL_rd->ascii_runs )
+      scan_ascii_run(0, _PL_rd);
     c = getchr();
   } while( c != EOF && PlIdContW(c) );
 
@@ -1114,6 +1224,7 @@ raw_read2(ReadData _PL_rd ARG_LD)
 
   clearBuffer(_PL_rd);				/* clear input buffer */
   _PL_rd->strictness = truePrologFlag(PLFLAG_ISO);
+  _PL_rd->ascii_runs = can_scan_ascii_runs(_PL_rd);
   source_line_no = -1;
 
   for(;;)
@@ -1411,6 +1522,7 @@ raw_read2(ReadData _PL_rd ARG_LD)
 		      goto handle_c;
 		    case LC:
 		    case UC:
+		    case DI:
 		      set_start_line;
 		      c = raw_read_identifier(c, _PL_rd);
 		      goto handle_c;
@@ -2660,6 +2772,11 @@ str_number(cucharp in, ucharp *end, Number value, int escape)
   if ( value->type == V_FLOAT )
   { char *e;
 
+    if ( fast_strtod((char*)start, (char*)in, &value->value.f) )
+    { *end = (ucharp)in;
+      return NUM_OK;
+    }
+
     errno = 0;
     value->value.f = strtod((char*)start, &e);
     if ( e != (char*)in && !(*in == '.' && (char*)in+1 == e) )
@@ -3697,16 +3814,70 @@ unify_string_position(term_t positions, Token token ARG_LD)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+data_term() is used instead of complex_term() if read_term/3 is called
+with data_only(true).  Such input consists of operator-free terms only:
+atoms, numbers, strings, variables, compounds in functional f(...) notation,
+lists and {}-terms.  There is no operator handling at all, so a term is
+a single simple_term() that must be followed by one of the stop tokens.
+As read_compound(), read_list() and read_brace_term() call complex_term()
+for their arguments, nested terms are read the same way.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+data_term(const char *stop, term_t positions, ReadData _PL_rd ARG_LD)
+{ Token token;
+  int rc;
+
+  if ( !(token = get_token(FALSE, _PL_rd)) )
+    return FALSE;
+  if ( token->type == T_PUNCTUATION &&
+       !strchr("([{", token->value.character) )
+    syntaxError("cannot_start_term", _PL_rd);
+
+  if ( (rc=simple_term(token, positions, _PL_rd PASS_LD)) != TRUE )
+    return rc;
+
+  if ( !(token = get_token(TRUE, _PL_rd)) )
+    return FALSE;
+  switch(token->type)
+  { case T_FULLSTOP:
+      if ( stop == NULL )
+	goto out;
+      break;
+    case T_PUNCTUATION:
+      if ( stop != NULL && strchr(stop, token->value.character) )
+	goto out;
+      break;
+#ifdef O_QUASIQUOTATIONS
+    case T_QQ_BAR:
+      if ( stop != NULL && stop[0] == '|' )
+	goto out;
+      break;
+#endif
+  }
+  syntaxError("operator_expected", _PL_rd);
+
+out:
+  unget_token();			/* the full-stop or punctuation */
+  return TRUE;
+}
+
+
 static int
 complex_term(const char *stop, short maxpri, term_t positions,
 	     ReadData _PL_rd ARG_LD)
 { op_entry  in_op;
   int out_n = 0, side_n = 0;
   int rmo = 0;				/* Rands more than operators */
-  int side_p = side_p0(_PL_rd);
+  int side_p;
   term_t pin;
   Token token;
 
+  if ( _PL_rd->data_only )
+    return data_term(stop, positions, _PL_rd PASS_LD);
+  side_p = side_p0(_PL_rd);
+
   if ( _PL_rd->strictness == 0 )
     maxpri = OP_MAXPRIORITY+1;
 
@@ -4859,6 +5030,7 @@ static const opt_spec read_term_options[] =
 #endif
   { ATOM_cycles,	    OPT_BOOL },
   { ATOM_dotlists,	    OPT_BOOL },
+  { ATOM_data_only,	    OPT_BOOL },
   { NULL_ATOM,		    0 }
 };
 
@@ -4897,7 +5069,8 @@ retry:
 		     &rd.quasi_quotations,
 #endif
 		     &rd.cycles,
-		     &rd.dotlists) )
+		     &rd.dotlists,
+		     &rd.data_only) )
     return FALSE;
 
   if ( mname )
@@ -5212,6 +5385,148 @@ PL_wchars_to_term(const wchar_t *s, term_t t)
 }
 
 
+		 /*******************************
+		 *	 CLAUSE BOUNDARIES	*
+		 *******************************/
+
+/* '$clause_boundaries'(+File, +Parts, -Offsets) is det.
+
+Split File into at most Parts chunks that each hold a sequence of
+complete clauses.  Offsets is a list of byte offsets [0, ..., Size],
+where each chunk runs from an offset to the next.  A chunk ends just
+after the first full stop that follows its nominal size, i.e., a `.`
+that is not part of a symbol-char atom and is followed by layout, `%`
+or the end of the file.  Quoted text, 0'c character codes and comments
+are skipped.  The scan is byte based, which is correct for all
+encodings in which these characters are ASCII (notably UTF-8).  This is
+used by load_data_file/2 to read a file concurrently.
+*/
+
+static inline int
+cb_next(IOSTREAM *s, int *peek, int64_t *here)
+{ int c = *peek;
+
+  *peek = Sgetcode(s);
+  (*here)++;
+
+  return c;
+}
+
+#define CB_PEEK()  (c1)
+#define CB_NEXT()  (c0 = cb_next(s, &c1, &here))
+
+static
+PRED_IMPL("$clause_boundaries", 3, clause_boundaries, 0)
+{ PRED_LD
+  char *name;
+  int parts;
+  IOSTREAM *s;
+  int64_t size, here = 0, last = 0, target;
+  int c0, c1, prev = ' ';
+  int part = 1;
+  term_t tail = PL_copy_term_ref(A3);
+  term_t head = PL_new_term_ref();
+
+  if ( !PL_get_file_name(A1, &name, 0) ||
+       !PL_get_integer_ex(A2, &parts) )
+    return FALSE;
+  if ( parts < 1 )
+    return PL_error(NULL, 0, NULL, ERR_DOMAIN, ATOM_not_less_than_one, A2);
+
+  if ( !(s = Sopen_file(name, "rbr")) )
+    return PL_error(NULL, 0, OsError(), ERR_FILE_OPERATION,
+		    ATOM_open, ATOM_source_sink, A1);
+  if ( (size = Ssize(s)) < 0 )
+  { Sclose(s);
+    return PL_error(NULL, 0, OsError(), ERR_FILE_OPERATION,
+		    ATOM_size, ATOM_source_sink, A1);
+  }
+
+  if ( !PL_unify_list(tail, head, tail) ||
+       !PL_unify_int64(head, 0) )
+    goto failed;
+  target = size/parts;
+  c1 = Sgetcode(s);
+
+  while ( part < parts && CB_NEXT() != -1 )
+  { switch(c0)
+    { case '%':
+	while( CB_NEXT() != -1 && c0 != '\n' )
+	  ;
+	c0 = ' ';
+	break;
+      case '/':
+	if ( CB_PEEK() == '*' && !(prev < 128 && isSymbol(prev)) )
+	{ CB_NEXT();
+	  for(;;)
+	  { if ( CB_NEXT() == -1 )
+	      break;
+	    if ( c0 == '*' && CB_PEEK() == '/' )
+	    { CB_NEXT();
+	      break;
+	    }
+	  }
+	  c0 = ' ';
+	}
+	break;
+      case '\'':
+      case '"':
+      case '`':
+      { int q = c0;
+
+	while( CB_NEXT() != -1 && c0 != q )
+	{ if ( c0 == '\\' )
+	    CB_NEXT();
+	}
+	break;
+      }
+      case '0':
+	if ( CB_PEEK() == '\'' && !(prev < 128 && isAlpha(prev)) )
+	{ CB_NEXT();
+	  if ( CB_NEXT() == '\\' || (c0 == '\'' && CB_PEEK() == '\'') )
+	    CB_NEXT();
+	  c0 = 'c';
+	}
+	break;
+      case '.':
+	if ( !(prev < 128 && isSymbol(prev)) &&
+	     ( CB_PEEK() == -1 || c1 == '%' || (c1 < 128 && isBlank(c1)) ) &&
+	     here >= target )
+	{ if ( !PL_unify_list(tail, head, tail) ||
+	       !PL_unify_int64(head, here) )
+	    goto failed;
+	  last = here;
+	  target = (size*(part+1))/parts;
+	  part++;
+	}
+	break;
+    }
+    prev = c0;
+  }
+
+  if ( Sferror(s) )
+  { Sclose(s);
+    return PL_error(NULL, 0, OsError(), ERR_FILE_OPERATION,
+		    ATOM_read, ATOM_source_sink, A1);
+  }
+  Sclose(s);
+
+  if ( last < size || part == 1 )
+  { if ( !PL_unify_list(tail, head, tail) ||
+	 !PL_unify_int64(head, size) )
+      return FALSE;
+  }
+  return PL_unify_nil(tail);
+
+failed:
+  Sclose(s);
+  return FALSE;
+}
+
+#undef CB_PEEK
+#undef CB_NEXT
+
+
 		 /*******************************
 		 *	     CODE TYPE		*
 		 *******************************/
@@ -5290,6 +5605,7 @@ BeginPredDefs(read)
   PRED_DEF("term_to_atom",	  2, term_to_atom,	  0)
   PRED_DEF("term_string",	  2, term_string,	  0)
   PRED_DEF("$code_class",	  2, code_class,	  0)
+  PRED_DEF("$clause_boundaries",  3, clause_boundaries,   0)
   PRED_DEF("$is_named_var",       1, is_named_var,        0)
 #ifdef O_QUASIQUOTATIONS
   PRED_DEF("$qq_open",            2, qq_open,             0)
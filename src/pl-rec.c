@@ -212,6 +212,10 @@ unallocRecordList(RecordList rl)
 	                         offsetof(struct record, references)) \
 
 #define dataRecord(r) ((char *)addPointer(r, SIZERECORD(r->flags)))
+#define imageRecord(r) ((char *)addPointer(r, (r)->size - \
+					    ((r)->gsize+1)*sizeof(word)))
+#define endCodeRecord(r) (true(r, R_IMAGE) ? imageRecord(r) \
+					   : (char *)addPointer(r, (r)->size))
 
 typedef enum
 { ENONE = 0,
@@ -225,6 +229,7 @@ typedef struct
   uint	     nvars;			/* # variables */
   int	     external;			/* Allow for external storage */
   int	     lock;			/* lock compiled atoms */
+  struct fastrw_table *dict;		/* Stream dictionary (fast_write/3) */
   cerror     error;			/* generated error */
   word	     econtext[1];		/* error context */
 } compile_info, *CompileInfo;
@@ -251,6 +256,11 @@ typedef struct
 
 #define PL_TYPE_EXT_COMPOUND_V2	(19)	/* Read V2 external records */
 
+#define PL_REC_DICT_ATOM	(20)	/* Add atom to stream dictionary */
+#define PL_REC_DICT_REF		(21)	/* Atom from stream dictionary */
+#define PL_REC_DICT_FUNCTOR	(22)	/* Add functor to stream dictionary */
+#define PL_REC_DICT_COMPOUND	(23)	/* Functor from stream dictionary */
+
 static const int v2_map[] =
 { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,		/* variable..string */
   11, 12, PL_TYPE_EXT_COMPOUND_V2, 14, 15, 16, 17, 18
@@ -263,6 +273,110 @@ static const int *v_maps[8] =		/* 3 bits, cannot overflow */
 };
 
 
+
+		 /*******************************
+		 *     STREAM DICTIONARIES	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The streaming mode of fast_write/3  sends   the  text  of  each atom and
+functor only once per stream. The first  occurrence is emitted using the
+PL_REC_DICT_ATOM or PL_REC_DICT_FUNCTOR opcode,   which  assigns it the
+next free id. Subsequent occurrences  use   PL_REC_DICT_REF  or
+PL_REC_DICT_COMPOUND, followed by the id. fast_read/2 maintains the same
+numbering as it reads the records in  order   and  thus does not need to
+know whether or not the writer uses a dictionary.
+
+The dictionaries are attached to the stream  context (see pl-file.c) and
+discarded when the stream is closed.  Atoms   in  the  dictionary are
+locked.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+typedef struct fastrw_table
+{ Table		ids;			/* object --> id+1 (output only) */
+  word	       *objects;		/* id --> atom_t or functor_t */
+  size_t	count;			/* # objects */
+  size_t	allocated;		/* allocated size of objects */
+} fastrw_table;
+
+typedef struct fastrw_dict
+{ fastrw_table	out;			/* fast_write/3 dictionary */
+  fastrw_table	in;			/* fast_read/2 dictionary */
+} fastrw_dict;
+
+
+static fastrw_dict *
+stream_fastrw_dict(IOSTREAM *s)
+{ fastrw_dict **dp = streamFastRWDict(s);
+
+  if ( !*dp )
+  { fastrw_dict *dict = allocHeapOrHalt(sizeof(*dict));
+
+    memset(dict, 0, sizeof(*dict));
+    *dp = dict;
+  }
+
+  return *dp;
+}
+
+
+static void
+add_fastrw_object(fastrw_table *t, word w)
+{ if ( t->count == t->allocated )
+  { size_t size = t->allocated ? t->allocated*2 : 256;
+    word *objects;
+
+    if ( !(objects = realloc(t->objects, size*sizeof(word))) )
+      outOfCore();
+    t->objects   = objects;
+    t->allocated = size;
+  }
+
+  if ( isAtom(w) )
+    PL_register_atom(w);
+  if ( t->ids )
+    addNewHTable(t->ids, (void*)w, (void*)(t->count+1));
+  t->objects[t->count++] = w;
+}
+
+
+static inline size_t
+lookup_fastrw_object(fastrw_table *t, word w)
+{ GET_LD
+
+  return (size_t)lookupHTable(t->ids, (void*)w);
+}
+
+
+/* truncate_fastrw_table() removes all objects with id >= count.  Used to
+   undo additions if compiling a term failed and to discard the table.
+*/
+
+static void
+truncate_fastrw_table(fastrw_table *t, size_t count)
+{ while( t->count > count )
+  { word w = t->objects[--t->count];
+
+    if ( t->ids )
+      deleteHTable(t->ids, (void*)w);
+    if ( isAtom(w) )
+      PL_unregister_atom(w);
+  }
+}
+
+
+void
+freeFastRWDict(fastrw_dict *dict)
+{ truncate_fastrw_table(&dict->out, 0);
+  truncate_fastrw_table(&dict->in, 0);
+  if ( dict->out.ids )
+    destroyHTable(dict->out.ids);
+  free(dict->out.objects);
+  free(dict->in.objects);
+  freeHeap(dict, sizeof(*dict));
+}
+
+
 static inline void
 addUnalignedBuf(TmpBuffer b, void *ptr, size_t bytes)
 { if ( b->top + bytes > b->max )
@@ -412,7 +526,19 @@ addAtom(CompileInfo info, atom_t a)
   { Atom ap = atomValue(a);
 
     if ( true(ap->type, PL_BLOB_TEXT) )
-    { if ( isUCSAtom(ap) )
+    { if ( info->dict )
+      { size_t id;
+
+	if ( (id=lookup_fastrw_object(info->dict, a)) )
+	{ addOpCode(info, PL_REC_DICT_REF);
+	  addSizeInt(info, id-1);
+	  return TRUE;
+	}
+	addOpCode(info, PL_REC_DICT_ATOM);
+	add_fastrw_object(info->dict, a);
+      }
+
+      if ( isUCSAtom(ap) )
 	addOpCode(info, PL_TYPE_EXT_WATOM);
       else
 	addOpCode(info, PL_TYPE_EXT_ATOM);
@@ -442,6 +568,23 @@ addFunctor(CompileInfo info, functor_t f)
   { if ( info->external )
     { FunctorDef fd = valueFunctor(f);
 
+      if ( info->dict )
+      { size_t id;
+
+	if ( (id=lookup_fastrw_object(info->dict, f)) )
+	{ addOpCode(info, PL_REC_DICT_COMPOUND);
+	  addSizeInt(info, id-1);
+	} else
+	{ addOpCode(info, PL_REC_DICT_FUNCTOR);
+	  addSizeInt(info, fd->arity);
+	  if ( !addAtom(info, fd->name) )
+	    return FALSE;
+	  add_fastrw_object(info->dict, f);
+	}
+
+	return TRUE;
+      }
+
       addOpCode(info, PL_TYPE_EXT_COMPOUND);
       addSizeInt(info, fd->arity);
       return addAtom(info, fd->name);
@@ -668,8 +811,16 @@ compileTermToHeap__LD() is the core of the recorded database.
 Returns NULL if there is insufficient   memory.  Otherwise the result of
 the  allocation  function.   The   default    allocation   function   is
 PL_malloc_atomic_unmanaged().
+
+If R_IMAGE is in flags and the term is ground and at least
+REC_IMAGE_MIN_GSIZE cells, space is reserved for   an image of the term
+as created on the global stack.  The   caller  must fill it using
+build_record_image() before the record is  used.   Otherwise, the R_IMAGE
+flag is cleared.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+#define REC_IMAGE_MIN_GSIZE 32
+
 Record
 compileTermToHeap__LD(term_t t,
 		      void* (*allocate)(void *closure, size_t size),
@@ -690,6 +841,7 @@ compileTermToHeap__LD(term_t t,
   info.nvars = 0;
   info.external = (flags & R_EXTERNAL);
   info.lock = !(info.external || (flags&R_NOLOCK));
+  info.dict = NULL;
 
   initTermAgenda(&agenda, 1, valTermRef(t));
   compile_term_to_heap(&agenda, &info PASS_LD);
@@ -698,6 +850,12 @@ compileTermToHeap__LD(term_t t,
   unvisit(PASS_LD1);
 
   size = rsize + sizeOfBuffer(&info.code);
+  if ( (flags&R_IMAGE) )
+  { if ( info.nvars == 0 && info.size >= REC_IMAGE_MIN_GSIZE )
+      size += (info.size+1)*sizeof(word);
+    else
+      flags &= ~R_IMAGE;
+  }
   if ( allocate )
     record = (*allocate)(closure, size);
   else
@@ -789,12 +947,252 @@ rec_error(CompileInfo info)
 }
 
 
+#if O_CYCLIC
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+share_ground_subterms() implements the share(true)  option of fast_write/3.
+It walks the term in post-order, computing a hash for each ground compound.
+If a ground compound is structurally equal   to one seen before, the cell
+that references it is redirected to   the  first copy. The existing cycle
+detection of compile_term_to_heap() then emits  a PL_REC_CYCLE reference
+for it, so the subterm is written once  and the reader creates a single
+shared copy. All modifications are saved  in   `undo`  and  reverted by
+restore_shared_subterms().
+
+Compounds are also remembered by address  to   avoid  walking a physically
+shared subterm more than once.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+typedef struct
+{ Word		location;		/* cell that references term */
+  Functor	term;			/* the compound */
+  size_t	arg;			/* next argument to process */
+  unsigned int	hash;			/* hash of processed part */
+  int		ground;			/* processed part is ground */
+} share_frame;
+
+typedef struct
+{ Functor	term;			/* compound */
+  Functor	canonical;		/* first equal ground compound */
+  unsigned int	hash;			/* hash of term */
+  int		ground;			/* term is ground */
+} share_entry;
+
+typedef struct
+{ share_entry  *entries;
+  size_t	size;			/* # entries (power of 2) */
+  size_t	count;			/* # used entries */
+} share_table;
+
+#define SHARE_MIX(h, v) (((h)^(v)) * 0x01000193U)
+
+static unsigned int
+share_hash_atomic(word w ARG_LD)
+{ if ( isIndirect(w) )
+  { Word p = addressIndirect(w);
+
+    return MurmurHashAligned2(p+1, wsizeofInd(*p)*sizeof(word), MURMUR_SEED);
+  }
+
+  return (unsigned int)(w ^ (w>>(sizeof(word)*4)));
+}
+
+
+static void
+init_share_table(share_table *t, size_t size)
+{ if ( !(t->entries = calloc(size, sizeof(*t->entries))) )
+    outOfCore();
+  t->size  = size;
+  t->count = 0;
+}
+
+
+/* share_slot() finds the slot for key in an open addressing table.  If
+   by_address is TRUE the key is the address of the compound, otherwise
+   it is the structure of the ground compound `term` with hash `hash`.
+*/
+
+static share_entry *
+share_slot(share_table *t, Functor term, unsigned int hash,
+	   int by_address ARG_LD)
+{ size_t i = (by_address ? pointerHashValue(term, t->size)
+			 : hash & (t->size-1));
+
+  for(;;)
+  { share_entry *e = &t->entries[i];
+
+    if ( !e->term || e->term == term )
+      return e;
+    if ( !by_address && e->hash == hash )
+    { word w1 = consPtr(e->term, TAG_COMPOUND|STG_GLOBAL);
+      word w2 = consPtr(term,    TAG_COMPOUND|STG_GLOBAL);
+
+      if ( compareStandard(&w1, &w2, TRUE PASS_LD) == CMP_EQUAL )
+	return e;
+    }
+
+    i = (i+1) & (t->size-1);
+  }
+}
+
+
+static share_entry *
+share_add(share_table *t, Functor term, unsigned int hash,
+	  int by_address ARG_LD)
+{ share_entry *e;
+
+  if ( t->count*2 >= t->size )
+  { share_table new;
+    size_t i;
+
+    init_share_table(&new, t->size*2);
+    for(i=0; i<t->size; i++)
+    { share_entry *o = &t->entries[i];
+
+      if ( o->term )
+	*share_slot(&new, o->term, o->hash, by_address PASS_LD) = *o;
+    }
+    new.count = t->count;
+    free(t->entries);
+    *t = new;
+  }
+
+  e = share_slot(t, term, hash, by_address PASS_LD);
+  if ( !e->term )
+  { e->term = term;
+    e->canonical = term;
+    e->hash = hash;
+    t->count++;
+  }
+
+  return e;
+}
+
+
+static void
+share_redirect(Word location, Functor to, TmpBuffer undo ARG_LD)
+{ addBuffer(undo, location, Word);
+  addBuffer(undo, *location, word);
+  *location = consPtr(to, TAG_COMPOUND|STG_GLOBAL);
+}
+
+
+static void
+share_ground_subterms(Word p, TmpBuffer undo ARG_LD)
+{ tmp_buffer stack;
+  share_table visited, ground;
+  share_frame fr;
+
+  deRef(p);
+  if ( !isTerm(*p) || !is_acyclic(p PASS_LD) )
+    return;
+
+  initBuffer(&stack);
+  init_share_table(&visited, 256);
+  init_share_table(&ground, 256);
+
+  fr.location = NULL;
+  fr.term     = valueTerm(*p);
+  fr.arg      = 0;
+  fr.hash     = share_hash_atomic(fr.term->definition PASS_LD);
+  fr.ground   = TRUE;
+  addBuffer(&stack, fr, share_frame);
+
+  while( !isEmptyBuffer(&stack) )
+  { share_frame *top = topBuffer(&stack, share_frame)-1;
+
+    if ( top->arg < arityFunctor(top->term->definition) )
+    { Word a = &top->term->arguments[top->arg++];
+
+      deRef(a);
+      if ( isTerm(*a) )
+      { Functor f = valueTerm(*a);
+	share_entry *e = share_slot(&visited, f, 0, TRUE PASS_LD);
+
+	if ( e->term )			/* walked before */
+	{ if ( e->ground )
+	  { top->hash = SHARE_MIX(top->hash, e->hash);
+	    if ( e->canonical != f )
+	      share_redirect(a, e->canonical, undo PASS_LD);
+	  } else
+	  { top->ground = FALSE;
+	  }
+	} else
+	{ fr.location = a;
+	  fr.term     = f;
+	  fr.arg      = 0;
+	  fr.hash     = share_hash_atomic(f->definition PASS_LD);
+	  fr.ground   = TRUE;
+	  addBuffer(&stack, fr, share_frame);
+	}
+      } else if ( canBind(*a) )
+      { top->ground = FALSE;
+      } else
+      { top->hash = SHARE_MIX(top->hash, share_hash_atomic(*a PASS_LD));
+      }
+    } else
+    { share_entry *e;
+
+      fr = popBuffer(&stack, share_frame);
+      e = share_add(&visited, fr.term, fr.hash, TRUE PASS_LD);
+      e->ground = fr.ground;
+      if ( fr.ground )
+      { share_entry *g = share_add(&ground, fr.term, fr.hash, FALSE PASS_LD);
+
+	e->canonical = g->term;
+	if ( g->term != fr.term && fr.location )
+	  share_redirect(fr.location, g->term, undo PASS_LD);
+      }
+
+      if ( !isEmptyBuffer(&stack) )
+      { top = topBuffer(&stack, share_frame)-1;
+
+	if ( fr.ground )
+	  top->hash = SHARE_MIX(top->hash, fr.hash);
+	else
+	  top->ground = FALSE;
+      }
+    }
+  }
+
+  discardBuffer(&stack);
+  free(visited.entries);
+  free(ground.entries);
+}
+
+
+static void
+restore_shared_subterms(TmpBuffer undo)
+{ while( !isEmptyBuffer(undo) )
+  { word w = popBuffer(undo, word);
+    Word location = popBuffer(undo, Word);
+
+    *location = w;
+  }
+  discardBuffer(undo);
+}
+
+#endif /*O_CYCLIC*/
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+compile_external_record() compiles t  into   data.  If  dict is non-NULL,
+atoms and functors are  emitted  using   the  stream  dictionary.  If
+share is TRUE, ground  subterms  that  are   structurally  equal  are
+written only once (see share_ground_subterms()).
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
 static int
-compile_external_record(term_t t, record_data *data ARG_LD)
+compile_external_record(term_t t, record_data *data,
+			fastrw_table *dict, int share ARG_LD)
 { Word p;
   int first = REC_HDR;
   term_agenda agenda;
   int scode, rc;
+  size_t dict_count = dict ? dict->count : 0;
+#if O_CYCLIC
+  tmp_buffer undo;
+#endif
 
   DEBUG(CHK_SECURE, checkData(valTermRef(t)));
   p = valTermRef(t);
@@ -804,6 +1202,7 @@ compile_external_record(term_t t, record_data *data ARG_LD)
   initBuffer(&data->info.code);
   data->info.external = TRUE;
   data->info.lock = FALSE;
+  data->info.dict = dict;
 
   if ( isInteger(*p) )			/* integer-only record */
   { int64_t v;
@@ -821,7 +1220,7 @@ compile_external_record(term_t t, record_data *data ARG_LD)
     data->simple = TRUE;
 
     return TRUE;
-  } else if ( isAtom(*p) )		/* atom-only record */
+  } else if ( isAtom(*p) && !dict )	/* atom-only record */
   { first |= (REC_ATOM|REC_GROUND);
     addOpCode(&data->info, first);
     if ( !addAtom(&data->info, *p) )
@@ -838,6 +1237,13 @@ general:
   data->info.size = 0;
   data->info.nvars = 0;
 
+#if O_CYCLIC
+  initBuffer(&undo);
+  if ( share )
+  { share_ground_subterms(p, (TmpBuffer)&undo PASS_LD);
+    init_cycle(PASS_LD1);		/* compareStandard() changed it */
+  }
+#endif
   initTermAgenda(&agenda, 1, p);
   rc = compile_term_to_heap(&agenda, &data->info PASS_LD);
   clearTermAgenda(&agenda);
@@ -845,8 +1251,15 @@ general:
     first |= REC_GROUND;
   restoreVars(&data->info);
   unvisit(PASS_LD1);
+#if O_CYCLIC
+  restore_shared_subterms((TmpBuffer)&undo);
+#endif
   if ( !rc )
+  { if ( dict )
+      truncate_fastrw_table(dict, dict_count);
+    discardBuffer(&data->info.code);
     return rec_error(&data->info);
+  }
   scode = (int)sizeOfBuffer(&data->info.code);
 
   initBuffer(&data->hdr);
@@ -864,7 +1277,7 @@ PL_record_external(term_t t, size_t *len)
 { GET_LD
   record_data data;
 
-  if ( compile_external_record(t, &data PASS_LD) )
+  if ( compile_external_record(t, &data, NULL, FALSE PASS_LD) )
   { if ( data.simple )
     { int scode = (int)sizeOfBuffer(&data.info.code);
       char *rec = malloc(scode);
@@ -922,7 +1335,7 @@ PRED_IMPL("fast_term_serialized", 2, fast_term_serialized, 0)
   if ( PL_is_variable(string) )
   { record_data data;
 
-    if ( compile_external_record(term, &data PASS_LD) )
+    if ( compile_external_record(term, &data, NULL, FALSE PASS_LD) )
     { if ( data.simple )
       { int rc;
 
@@ -967,19 +1380,48 @@ PRED_IMPL("fast_term_serialized", 2, fast_term_serialized, 0)
 }
 
 /** fast_write(+Stream, +Term)
+    fast_write(+Stream, +Term, +Options)
+
+Options:
+
+  - dictionary(+Bool)
+    Use the stream dictionary for atoms and functors.
+  - share(+Bool)
+    Write structurally equal ground subterms only once.
 */
 
-static
-PRED_IMPL("fast_write", 2, fast_write, 0)
-{ PRED_LD
-  IOSTREAM *out;
+static const opt_spec fast_write_options[] =
+{ { ATOM_dictionary,	OPT_BOOL },
+  { ATOM_share,		OPT_BOOL },
+  { NULL_ATOM,		0 }
+};
 
-  if ( PL_get_stream(A1, &out, SIO_OUTPUT) )
+static int
+fast_write(term_t stream, term_t term, term_t options ARG_LD)
+{ IOSTREAM *out;
+  int use_dict = FALSE;
+  int share = FALSE;
+
+  if ( options &&
+       !scan_options(options, 0, ATOM_fast_write_option, fast_write_options,
+		     &use_dict, &share) )
+    return FALSE;
+
+  if ( PL_get_stream(stream, &out, SIO_OUTPUT) )
   { record_data data;
+    fastrw_table *dict = NULL;
+    size_t dict_count = 0;
     int rc;
 
     if ( out->encoding == ENC_OCTET )
-    { if ( (rc=compile_external_record(A2, &data PASS_LD)) )
+    { if ( use_dict )
+      { dict = &stream_fastrw_dict(out)->out;
+	if ( !dict->ids )
+	  dict->ids = newHTable(64);
+	dict_count = dict->count;
+      }
+
+      if ( (rc=compile_external_record(term, &data, dict, share PASS_LD)) )
       { if ( data.simple )
 	{ size_t len = sizeOfBuffer(&data.info.code);
 
@@ -994,9 +1436,11 @@ PRED_IMPL("fast_write", 2, fast_write, 0)
 	}
 
 	discard_record_data(&data);
+	if ( !rc && dict )		/* the reader did not see the */
+	  truncate_fastrw_table(dict, dict_count); /* new entries */
       }
     } else
-    { rc = PL_permission_error("fast_write", "stream", A1);
+    { rc = PL_permission_error("fast_write", "stream", stream);
     }
 
     return PL_release_stream(out) && rc;
@@ -1006,8 +1450,27 @@ PRED_IMPL("fast_write", 2, fast_write, 0)
 }
 
 
+static
+PRED_IMPL("fast_write", 2, fast_write, 0)
+{ PRED_LD
+
+  return fast_write(A1, A2, 0 PASS_LD);
+}
+
+
+static
+PRED_IMPL("fast_write", 3, fast_write, 0)
+{ PRED_LD
+
+  return fast_write(A1, A2, A3 PASS_LD);
+}
+
+
 #define FASTRW_FAST 512
 
+static int recorded_external(const char *rec, term_t t,
+			     fastrw_table *dict ARG_LD);
+
 static char *
 readSizeInt(IOSTREAM *in, char *to, size_t *sz)
 { size_t r = 0;
@@ -1141,7 +1604,8 @@ PRED_IMPL("fast_read", 2, fast_read, 0)
       { term_t tmp;
 
 	rc = ( (tmp = PL_new_term_ref()) &&
-	       PL_recorded_external(rec, tmp) &&
+	       recorded_external(rec, tmp,
+				 &stream_fastrw_dict(in)->in PASS_LD) &&
 	       PL_unify(A2, tmp) );
       }
 
@@ -1175,6 +1639,7 @@ typedef struct
   uint		nvars;			/* Variables seen */
   uint		dicts;			/* # dicts found */
   TmpBuffer	avars;			/* Values stored for attvars */
+  fastrw_table *dict;			/* Stream dictionary (fast_read/2) */
   Word	        vars_buf[MAX_FAST_VARS];
 } copy_info, *CopyInfo;
 
@@ -1315,6 +1780,50 @@ fetchChars(CopyInfo b, unsigned len, Word to)
 }
 
 
+/* fetchDictAtom() processes the remainder of a PL_REC_DICT_ATOM opcode.
+   The returned atom is registered, as with fetchAtom().  Fails if the
+   record is not restored with a stream dictionary.
+*/
+
+static int
+fetchDictAtom(CopyInfo b, atom_t *a)
+{ if ( !b->dict )
+    return FALSE;
+
+  if ( fetchOpCode(b) == PL_TYPE_EXT_WATOM )
+    fetchAtomW(b, a);
+  else
+    fetchAtom(b, a);
+  add_fastrw_object(b->dict, *a);
+
+  return TRUE;
+}
+
+
+/* fetchDictObject() processes the remainder of a PL_REC_DICT_REF or
+   PL_REC_DICT_COMPOUND opcode.  Fails if there is no dictionary or the
+   id does not refer to an atom (functor is FALSE) or functor (functor
+   is TRUE) in it.  This happens if the record is read from another
+   stream than it was written to or is restored using
+   PL_recorded_external().
+*/
+
+static int
+fetchDictObject(CopyInfo b, int functor, word *w)
+{ size_t id = fetchSizeInt(b);
+  word o;
+
+  if ( !b->dict || id >= b->dict->count )
+    return FALSE;
+  o = b->dict->objects[id];
+  if ( functor ? !isFunctor(o) : !isAtom(o) )
+    return FALSE;
+
+  *w = o;
+  return TRUE;
+}
+
+
 static int
 copy_record(Word p, CopyInfo b ARG_LD)
 { term_agenda agenda;
@@ -1386,6 +1895,17 @@ copy_record(Word p, CopyInfo b ARG_LD)
 	PL_unregister_atom(*p);
 	continue;
       }
+      case PL_REC_DICT_ATOM:
+      { if ( !fetchDictAtom(b, p) )
+	  goto invalid;
+	PL_unregister_atom(*p);
+	continue;
+      }
+      case PL_REC_DICT_REF:
+      { if ( !fetchDictObject(b, FALSE, p) )
+	  goto invalid;
+	continue;
+      }
       case PL_TYPE_TAGGED_INTEGER:
       { int64_t val = fetchInt64(b);
 	*p = consInt(val);
@@ -1497,6 +2017,46 @@ copy_record(Word p, CopyInfo b ARG_LD)
 	fdef = lookupFunctorDef(name, arity);
 	goto compound;
       }
+      case PL_REC_DICT_FUNCTOR:
+      { atom_t name;
+
+	if ( !b->dict )
+	  goto invalid;
+	arity = (int)fetchSizeInt(b);
+	switch(fetchOpCode(b))
+	{ case PL_REC_DICT_ATOM:
+	    if ( !fetchDictAtom(b, &name) )
+	      goto invalid;
+	    PL_unregister_atom(name);
+	    break;
+	  case PL_REC_DICT_REF:
+	    if ( !fetchDictObject(b, FALSE, &name) )
+	      goto invalid;
+	    break;
+	  case PL_TYPE_NIL:
+	    name = ATOM_nil;
+	    break;
+	  case PL_TYPE_DICT:
+	    b->dicts++;
+	    name = ATOM_dict;
+	    break;
+	  default:
+	    name = 0;
+	    assert(0);
+	}
+
+	fdef = lookupFunctorDef(name, arity);
+	add_fastrw_object(b->dict, fdef);
+	goto compound;
+      }
+      case PL_REC_DICT_COMPOUND:
+      { if ( !fetchDictObject(b, TRUE, &fdef) )
+	  goto invalid;
+	arity = arityFunctor(fdef);
+	if ( nameFunctor(fdef) == ATOM_dict )
+	  b->dicts++;
+	goto compound;
+      }
       case PL_TYPE_EXT_COMPOUND_V2:
       { atom_t name;
 
@@ -1526,6 +2086,91 @@ copy_record(Word p, CopyInfo b ARG_LD)
   } while ( is_compound && (p=nextTermAgendaNoDeRef(&agenda)) );
 
   return TRUE;
+
+invalid:				/* invalid stream dictionary reference */
+  if ( is_compound )
+    clearTermAgenda(&agenda);
+  return FALSE;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Ground stack images
+
+Records compiled with R_IMAGE carry, after the  code, a copy of the term
+as copy_record() creates it on the global stack, preceded by the cell
+that refers to it.  Pointers in the  image   are  relative to the image
+start.  Retrieving such a record is  a   memcpy()  followed by a single
+pass that relocates the pointers. Ground terms on the global stack only
+contain atomic cells, functors, pointers to compounds and indirects, and
+indirects. The latter are skipped using their header.
+
+The image is created by  decoding  the  record   into  the  free  space
+above gTop. The image is not aligned and only accessed using memcpy().
+If there is not enough space, the  R_IMAGE   flag  is  cleared and the
+record is decoded normally.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define globalOffset(p) \
+	((word)((uintptr_t)(p) - LD->bases[STG_GLOBAL]) << 5)
+
+static inline word
+relocate_ground_cell(word w, word delta)
+{ if ( storage(w) == STG_GLOBAL && tag(w) != TAG_ATOM ) /* not a functor */
+    return w + delta;
+
+  return w;
+}
+
+
+static void
+relocate_ground_cells(Word p, Word end, word delta)
+{ for( ; p < end; p++ )
+  { word w = *p;
+
+    if ( storage(w) == STG_GLOBAL )
+    { if ( tag(w) != TAG_ATOM )
+	*p = w + delta;
+    } else if ( storage(w) == STG_LOCAL )	/* indirect header */
+    { p += wsizeofInd(w)+1;
+    }
+  }
+}
+
+
+static void
+build_record_image(Record r ARG_LD)
+{ copy_info b;
+  word root;
+  Word g;
+  word delta;
+  char *img;
+
+  if ( ensureGlobalSpace(r->gsize, ALLOW_GC) != TRUE )
+  { clear(r, R_IMAGE);
+    return;
+  }
+
+  g = gTop;
+  b.base = b.data = dataRecord(r);
+  b.gbase = b.gstore = g;
+  b.version_map = NULL;
+  b.dict = NULL;
+  b.vars = NULL;
+
+  if ( copy_record(&root, &b PASS_LD) != TRUE )
+  { clear(r, R_IMAGE);
+    return;
+  }
+  assert(b.gstore == g+r->gsize);
+
+  delta = (word)0 - globalOffset(g);
+  root = relocate_ground_cell(root, delta);
+  relocate_ground_cells(g, g+r->gsize, delta);
+
+  img = imageRecord(r);
+  memcpy(img, &root, sizeof(word));
+  memcpy(img+sizeof(word), g, r->gsize*sizeof(word));
 }
 
 
@@ -1543,9 +2188,25 @@ copyRecordToGlobal(term_t copy, Record r, int flags ARG_LD)
   { if ( (rc=ensureGlobalSpace(r->gsize, flags)) != TRUE )
       return rc;
   }
+
+  if ( true(r, R_IMAGE) )
+  { char *img = imageRecord(r);
+    word delta = globalOffset(gTop);
+    word root;
+
+    memcpy(&root, img, sizeof(word));
+    memcpy(gTop, img+sizeof(word), r->gsize*sizeof(word));
+    relocate_ground_cells(gTop, gTop+r->gsize, delta);
+    *valTermRef(copy) = relocate_ground_cell(root, delta);
+    gTop += r->gsize;
+    DEBUG(CHK_SECURE, checkData(valTermRef(copy)));
+
+    return TRUE;
+  }
   b.base = b.data = dataRecord(r);
   b.gbase = b.gstore = gTop;
   b.version_map = NULL;
+  b.dict = NULL;
 
   if ( (rc=init_copy_vars(&b, r->nvars)) == TRUE )
   { gTop += r->gsize;
@@ -1745,7 +2406,7 @@ markAtomsRecord(Record record)
   ci.base = ci.data = dataRecord(record);
   ci.version_map = NULL;
   scanAtomsRecord(&ci, markAtom);
-  assert(ci.data == addPointer(record, record->size));
+  assert(ci.data == endCodeRecord(record));
 #endif
 }
 
@@ -1776,7 +2437,7 @@ freeRecord(Record record)
 #else
     scanAtomsRecord(&ci, PL_unregister_atom);
 #endif
-    assert(ci.data == addPointer(record, record->size));
+    assert(ci.data == endCodeRecord(record));
   }
 #endif
 
@@ -1808,16 +2469,23 @@ freeRecordRef(RecordRef r)
 		 *	 EXTERNAL RECORDS	*
 		 *******************************/
 
-int
-PL_recorded_external(const char *rec, term_t t)
-{ GET_LD
-  copy_info b;
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+recorded_external() restores an external record.  If dict is non-NULL it
+is the input dictionary of the stream the  record is read from, which is
+needed to restore records written by fast_write/3 using dictionary(true).
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+recorded_external(const char *rec, term_t t, fastrw_table *dict ARG_LD)
+{ copy_info b;
   uint gsize;
   uchar m;
   int rc;
+  Word attvars;
 
   b.base = b.data = rec;
   b.version_map = NULL;
+  b.dict = dict;
   fetchBuf(&b, &m, uchar);
 
   if ( !REC_COMPAT(m) )
@@ -1875,6 +2543,7 @@ PL_recorded_external(const char *rec, term_t t)
   if ( !(b.gbase = b.gstore = allocGlobal(gsize)) )
     return FALSE;			/* global stack overflow */
   b.dicts = 0;
+  attvars = LD->attvar.attvars;
   if ( !(m & REC_GROUND) )
   { uint nvars = fetchSizeInt(&b);
 
@@ -1886,8 +2555,15 @@ PL_recorded_external(const char *rec, term_t t)
   { rc = copy_record(valTermRef(t), &b PASS_LD);
   }
 
-  if ( rc != TRUE )
+  if ( rc != TRUE )			/* discard the partial term */
+  { gTop = b.gbase;
+    LD->attvar.attvars = attvars;
+    setVar(*valTermRef(t));
+
+    if ( rc == FALSE )
+      return PL_syntax_error("fastrw_dictionary", NULL);
     return raiseStackOverflow(rc);
+  }
 
   assert(b.gstore == gTop);
 
@@ -1899,6 +2575,14 @@ PL_recorded_external(const char *rec, term_t t)
 }
 
 
+int
+PL_recorded_external(const char *rec, term_t t)
+{ GET_LD
+
+  return recorded_external(rec, t, NULL PASS_LD);
+}
+
+
 int
 PL_erase_external(char *rec)
 { PL_free(rec);
@@ -2020,8 +2704,10 @@ record(term_t key, term_t term, term_t ref, int az)
   if ( ref && !PL_is_variable(ref) )
     return PL_uninstantiation_error(ref);
 
-  if ( !(copy = compileTermToHeap(term, 0)) )
+  if ( !(copy = compileTermToHeap(term, R_IMAGE)) )
     return PL_no_memory();
+  if ( true(copy, R_IMAGE) )
+    build_record_image(copy PASS_LD);
   r = allocHeapOrHalt(sizeof(*r));
   r->record = copy;
   if ( ref && !PL_unify_recref(ref, r) )
@@ -2395,5 +3081,6 @@ BeginPredDefs(rec)
 
   PRED_DEF("fast_term_serialized", 2, fast_term_serialized, 0)
   PRED_DEF("fast_write",	   2, fast_write,	    0)
+  PRED_DEF("fast_write",	   3, fast_write,	    0)
   PRED_DEF("fast_read",		   2, fast_read,	    0)
 EndPredDefs
@@ -100,6 +100,7 @@ setupProlog(void)
 
   initPrologLocalData(PASS_LD1);
   LD->tabling.node_pool.limit = GD->options.tableSpace;
+  LD->tabling.compile_threshold = TRIE_COMPILE_THRESHOLD;
 #ifdef O_PLMT
   GD->tabling.node_pool.limit = GD->options.sharedTableSpace;
 #endif
@@ -1672,6 +1673,8 @@ freePrologLocalData(PL_local_data_t *ld)
   if ( ld->qlf.getstr_buffer )
     free(ld->qlf.getstr_buffer);
 
+  freeFormatCache(ld);
+
   clearThreadTablingData(ld);
 }
 
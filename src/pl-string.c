@@ -296,19 +296,16 @@ PRED_IMPL("split_string", 4, split_string, 0)
     term_t head = PL_new_term_ref();
     size_t sep_at = (size_t)-1;
     size_t end;
+    char_set seps, pads;
 
+    init_char_set(&seps, &sep);
+    init_char_set(&pads, &pad);
 						/* back skip padding at end */
-    for(end=input.length;
-	end > 0 &&
-	text_chr(&pad, text_get_char(&input, end-1)) != (size_t)-1;
-	end--)
-      ;
+    end = text_back_skip_set(&input, 0, input.length, &pads);
 
     for(i=0;;)
     {					/* skip padding */
-      while( i<end &&
-	     text_chr(&pad, text_get_char(&input, i)) != (size_t)-1 )
-	i++;
+      i = text_find_set(&input, i, end, &pads, FALSE);
 
       if ( i == end )
       { if ( !PL_unify_list_ex(tail, head, tail) ||
@@ -319,13 +316,9 @@ PRED_IMPL("split_string", 4, split_string, 0)
 
     no_skip_padding:
       last = i;				/* find sep */
-      while( i<end &&
-	     text_chr(&sep, text_get_char(&input, i)) == (size_t)-1 )
-	i++;
+      i = text_find_set(&input, i, end, &seps, TRUE);
       sep_at = i;			/* back skip padding */
-      while( i>last &&
-	     text_chr(&pad, text_get_char(&input, i-1)) != (size_t)-1 )
-	i--;
+      i = text_back_skip_set(&input, last, i, &pads);
 
       if ( !PL_unify_list_ex(tail, head, tail) ||
 	   !PL_unify_text_range(head, &input, last, i-last, PL_STRING) )
@@ -336,8 +329,8 @@ PRED_IMPL("split_string", 4, split_string, 0)
 
       i = sep_at+1;
 
-      if ( text_chr(&pad, text_get_char(&input, sep_at)) == (size_t)-1 &&
-	   text_chr(&sep, text_get_char(&input, sep_at+1)) != (size_t)-1 )
+      if ( !char_set_member(&pads, text_get_char(&input, sep_at)) &&
+	   char_set_member(&seps, text_get_char(&input, sep_at+1)) )
 	goto no_skip_padding;
     }
 
@@ -370,6 +363,43 @@ backSkipPadding(const char *in, size_t len, PL_chars_t *pad)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+read_text_run() appends the text that  can   be  taken from the current
+buffer of s without Sgetcode() to b  and   returns  the number of added
+characters.  Decoding a byte produces at most two bytes of UTF-8.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static size_t
+read_text_run(IOSTREAM *s, Buffer b, size_t maxchars,
+	      const unsigned char *stop)
+{ size_t chars = maxchars;
+  size_t avail = s->limitp - s->bufp;
+
+  if ( avail == 0 || !growBuffer(b, avail*2) )
+    return 0;
+  b->top += Sread_text(s, b->top, freeSpaceBuffer(b), &chars, stop);
+
+  return chars;
+}
+
+
+static int
+ascii_stop_set(PL_chars_t *text, unsigned char stop[16])
+{ size_t i;
+
+  memset(stop, 0, 16);
+  for(i=0; i<text->length; i++)
+  { int c = text_get_char(text, i);
+
+    if ( c >= 128 )
+      return FALSE;
+    stop[c>>3] |= 1<<(c&7);
+  }
+
+  return TRUE;
+}
+
+
 /** read_string(+Stream, +Delimiters, +Padding, -Delimiter, -String)
 */
 
@@ -389,7 +419,9 @@ PRED_IMPL("read_string", 5, read_string, 0)
   if ( getTextInputStream(A1, &s) &&
        PL_get_text(A2, &sep, flags) &&
        PL_get_text(A3, &pad, flags) )
-  { int chr;
+  { unsigned char stop[16];
+    int runs = ascii_stop_set(&sep, stop);
+    int chr;
 
     do
     { chr = Sgetcode(s);
@@ -401,6 +433,8 @@ PRED_IMPL("read_string", 5, read_string, 0)
       if ( chr == EOF || text_chr(&sep, chr) != (size_t)-1 )
 	break;
       addUTF8Buffer((Buffer)&tmpbuf, chr);
+      if ( runs )
+	read_text_run(s, (Buffer)&tmpbuf, (size_t)-1, stop);
       chr = Sgetcode(s);
     }
 
@@ -446,16 +480,21 @@ PRED_IMPL("read_string", 3, read_string, 0)
        ( (vlen=PL_is_variable(A2)) ||
 	 PL_get_size_ex(A2, &len)
        ) )
-  { size_t count;
+  { size_t count = 0;
 
-    for(count=0; count < len; count++)
-    { int chr = Sgetcode(s);
-      if ( chr == EOF )
+    while( count < len )
+    { int chr;
+
+      count += read_text_run(s, (Buffer)&tmpbuf, len-count, NULL);
+      if ( count == len )
+	break;
+      if ( (chr = Sgetcode(s)) == EOF )
       { if ( Sferror(s) )
 	  goto out;
 	break;
       }
       addUTF8Buffer((Buffer)&tmpbuf, chr);
+      count++;
     }
 
     rc = ( PL_unify_chars(A3, PL_STRING|REP_UTF8,
@@ -2460,6 +2460,9 @@ new_worklist(trie *trie)
     wl->ground = TRUE;
   initBuffer(&wl->delays);
   initBuffer(&wl->pos_undefined);
+#ifdef O_TRIE_STATS
+  wl->created = WallTime();
+#endif
   trie->data.worklist = wl;
 
   return wl;
@@ -2640,7 +2643,8 @@ wkl_add_answer(worklist *wl, trie_node *node ARG_LD)
 
 static int
 wkl_add_suspension(worklist *wl, term_t suspension, int is_tnot ARG_LD)
-{ potentially_add_to_global_worklist(wl PASS_LD);
+{ TRIE_STAT_INC(wl->table, suspensions);
+  potentially_add_to_global_worklist(wl PASS_LD);
   if ( wl->tail && wl->tail->type == CLUSTER_SUSPENSIONS )
   { if ( !add_to_suspension_cluster(wl->tail, suspension, is_tnot PASS_LD) )
       return FALSE;
@@ -3011,7 +3015,8 @@ PRED_IMPL("$tbl_wkl_add_answer", 4, tbl_wkl_add_answer, 0)
 	  { clear(node, TN_IDG_DELETED);
 	    goto update_dl;
 	  } else
-	  { if ( answer_is_conditional(node) )
+	  { TRIE_STAT_INC(wl->table, duplicate_answers);
+	    if ( answer_is_conditional(node) )
 	    { if ( update_delay_list(wl, node, A2, A3 PASS_LD) == UDL_COMPLETE )
 		return PL_unify_atom(A4, ATOM_cut);
 	    }
@@ -3040,6 +3045,7 @@ PRED_IMPL("$tbl_wkl_add_answer", 4, tbl_wkl_add_answer, 0)
 	    ;
 	}
 
+	TRIE_STAT_INC(wl->table, answers);
 	return wkl_add_answer(wl, node PASS_LD);
       }
     }
@@ -3096,6 +3102,8 @@ PRED_IMPL("$tbl_wkl_mode_add_answer", 4, tbl_wkl_mode_add_answer, 0)
 	       PL_call_predicate(NULL, PL_Q_PASS_EXCEPTION, PRED_update4, av) &&
 	       set_trie_value(wl->table, node, av+3 PASS_LD)) )
 	{ DEBUG(MSG_TABLING_MODED, Sdprintf("No change!\n"));
+	  if ( !PL_exception(0) )
+	    TRIE_STAT_INC(wl->table, duplicate_answers);
 	  return FALSE;
 	}
 
@@ -3103,6 +3111,7 @@ PRED_IMPL("$tbl_wkl_mode_add_answer", 4, tbl_wkl_mode_add_answer, 0)
 	      { Sdprintf("Updated answer to: ");
 		PL_write_term(Serror, av+3, 1200, PL_WRT_NEWLINE);
 	      });
+	TRIE_STAT_INC(wl->table, answers);
 	return wkl_add_answer(wl, node PASS_LD);
       } else
       { if ( !set_trie_value(wl->table, node, A3 PASS_LD) )
@@ -3112,6 +3121,7 @@ PRED_IMPL("$tbl_wkl_mode_add_answer", 4, tbl_wkl_mode_add_answer, 0)
 	      { Sdprintf("Set first answer: ");
 		PL_write_term(Serror, A3, 1200, PL_WRT_NEWLINE);
 	      });
+	TRIE_STAT_INC(wl->table, answers);
 	return wkl_add_answer(wl, node PASS_LD);
       }
     }
@@ -3748,13 +3758,25 @@ wls_reeval_complete(worklist **wls, size_t ntables)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Unify cl with the compiled answer trie of   the leader.  If compilation
+is deferred (see trie_compile_deferred()) we  unify   with  the trie
+itself.  trie_gen_compiled/2,3 then  counts  the   leader  as  the first
+consumer and enumerates the trie directly.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
 static int
 unify_leader_clause(tbl_component *scc, term_t cl ARG_LD)
 { trie *atrie = scc->leader;
-  Procedure proc = (true(atrie, TRIE_ISMAP)
-			     ? GD->procedures.trie_gen_compiled3
-			     : GD->procedures.trie_gen_compiled2);
-  atom_t clref = compile_trie(proc->definition, atrie PASS_LD);
+  Procedure proc;
+  atom_t clref;
+
+  if ( atrie->value_count > 0 && trie_compile_deferred(atrie, FALSE PASS_LD) )
+    return _PL_unify_atomic(cl, trie_symbol(atrie));
+
+  proc = (true(atrie, TRIE_ISMAP) ? GD->procedures.trie_gen_compiled3
+				  : GD->procedures.trie_gen_compiled2);
+  clref = compile_trie(proc->definition, atrie PASS_LD);
 
   TRIE_STAT_INC(atrie, gen_call);
   return _PL_unify_atomic(cl, clref);
@@ -3792,6 +3814,10 @@ PRED_IMPL("$tbl_table_complete_all", 3, tbl_table_complete_all, 0)
     { worklist *wl = wls[i];
       trie *atrie = wl->table;
 
+#ifdef O_TRIE_STATS
+      atrie->stats.completion_time += WallTime() - wl->created;
+#endif
+
       DEBUG(MSG_TABLING_WORK,
 	    { term_t t = PL_new_term_ref();
 	      unify_trie_term(atrie->data.variant, t PASS_LD);
@@ -4376,6 +4402,22 @@ PRED_IMPL("$tbl_answer_update_dl", 2, tbl_answer_update_dl,
   return trie_gen(A1, A2, 0, A2, answer_update_delay_list, &ctx, PL__ctx);
 }
 
+/** '$tbl_answer_update_dl'(+ATrie, -Skeleton, -Value) is nondet.
+ *
+ * As '$tbl_answer_update_dl'/2 for moded tables.  This is the
+ * uncompiled counterpart of trie_gen_compiled/3.
+ */
+
+static
+PRED_IMPL("$tbl_answer_update_dl", 3, tbl_answer_update_dl,
+	  PL_FA_NONDETERMINISTIC)
+{ update_dl_ctx ctx;
+
+  ctx.atrie = A1;
+
+  return trie_gen(A1, A2, A3, A2, answer_update_delay_list, &ctx, PL__ctx);
+}
+
 
 /** '$tbl_implementation'(:G0, -G) is det.
  *
@@ -5725,6 +5767,7 @@ BeginPredDefs(tabling)
   PRED_DEF("$tbl_answer",               3, tbl_answer,            NDET)
   PRED_DEF("$tbl_answer_dl",		3, tbl_answer_dl,         NDET)
   PRED_DEF("$tbl_answer_update_dl",     2, tbl_answer_update_dl,  NDET)
+  PRED_DEF("$tbl_answer_update_dl",     3, tbl_answer_update_dl,  NDET)
   PRED_DEF("$tbl_force_truth_value",    3, tbl_force_truth_value,    0)
   PRED_DEF("$tbl_set_answer_completed", 1, tbl_set_answer_completed, 0)
   PRED_DEF("$tbl_is_answer_completed",  1, tbl_is_answer_completed,  0)
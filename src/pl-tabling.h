@@ -118,6 +118,9 @@ typedef struct worklist
 
   buffer	delays;			/* Delayed answers */
   buffer	pos_undefined;		/* Positive undefined */
+#ifdef O_TRIE_STATS
+  double	created;		/* Wall time of creation */
+#endif
 } worklist;
 
 
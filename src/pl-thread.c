@@ -1838,6 +1838,7 @@ copy_local_data(PL_local_data_t *ldnew, PL_local_data_t *ldold,
   }
 
   ldnew->tabling.node_pool.limit  = ldold->tabling.node_pool.limit;
+  ldnew->tabling.compile_threshold= ldold->tabling.compile_threshold;
   ldnew->statistics.start_time    = WallTime();
   ldnew->prolog_flag.mask	  = ldold->prolog_flag.mask;
   ldnew->prolog_flag.occurs_check = ldold->prolog_flag.occurs_check;
@@ -6504,6 +6505,40 @@ pl_kvs_in_use(KVS kvs)
 }
 
 
+		 /*******************************
+		 *	   TRIES IN USE		*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Return the oldest generation  at  which  some   thread  started  to access
+tries (see enter_trie_access() in pl-trie.c)  or GEN_MAX if no thread is
+accessing tries.  Trie nodes retired before this generation may be freed.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+gen_t
+oldest_trie_access_generation(void)
+{ gen_t oldest = GEN_MAX;
+#ifdef O_PLMT
+  int i;
+
+  for(i=1; i<=thread_highest_id; i++)
+  { PL_thread_info_t *info = GD->thread.threads[i];
+    gen_t gen;
+
+    if ( info && (gen=info->access.trie_generation) && gen < oldest )
+      oldest = gen;
+  }
+#else
+  GET_LD
+
+  if ( LD->tries.accessing )
+    oldest = LD->tries.generation;
+#endif
+
+  return oldest;
+}
+
+
 		 /*******************************
 		 *      ATOM-TABLE IN USE       *
 		 *******************************/
@@ -110,6 +110,7 @@ typedef struct _PL_thread_info_t
     FunctorTable    functor_table;	/* current atom-table accessed */
     Definition	    predicate;		/* current predicate walked */
     struct PL_local_data *ldata;	/* current ldata accessed */
+    gen_t	    trie_generation;	/* generation of oldest trie access */
   } access;
 } PL_thread_info_t;
 
@@ -469,6 +470,7 @@ COMMON(Atom**)	pl_atom_buckets_in_use(void);
 COMMON(Definition*)	predicates_in_use(void);
 COMMON(int)	pl_functor_table_in_use(FunctorTable functor_table);
 COMMON(int)	pl_kvs_in_use(KVS kvs);
+COMMON(gen_t)	oldest_trie_access_generation(void);
 COMMON(gen_t)	pushPredicateAccess__LD(Definition def ARG_LD);
 COMMON(void)	popPredicateAccess__LD(Definition def ARG_LD);
 COMMON(size_t)	popNPredicateAccess__LD(size_t n ARG_LD);
@@ -41,25 +41,36 @@
 #define AC_TERM_WALK_POP 1
 #include "pl-termwalk.c"
 #include "pl-dbref.h"
+#if defined(__SSE2__) && SIZEOF_VOIDP == 8
+#include <emmintrin.h>
+#define O_TRIE_SSE2 1
+#endif
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 This file implements tries of  terms.  The   trie  itself  lives  in the
 program space and is represented by a (symbol) handle. This implies that
 tries are subject to garbage collection.
 
+The children of a node are represented depending on their number. A
+single child is represented using a trie_children_key, up to
+TN_ARRAY_MAX children using a trie_children_array and more using a hash
+table.  Arrays are filled from the start and grow by allocating a larger
+copy.
+
 A path through a trie represents a  sequence of tokens. For representing
 terms, these tokens are functor symbols,   variables  and atomic values.
 The _value_ associated with a  term  always   appears  in  a _leaf_ node
 because a sequence that represents a term   is  _never_ the prefix of of
 the sequence of another term.
 
+Nodes and children blocks that are unlinked from the trie are not freed
+immediately as other threads may be walking over  them.  Instead, they
+are _retired_ in the current global  generation   and  freed when all
+threads that accessed tries at that time have finished.
+
 TODO
   - Limit size of the tries
-  - Avoid using a hash-table for small number of branches
-  - Thread safe reclaiming
-    - Reclaim single-child node after moving to a hash
-    - Make pruning the trie thread-safe
-  - Provide deletion from a trie
+  - Make concurrent insertion and pruning of the same path safe
   - Make trie_gen/3 take the known prefix into account
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -94,6 +105,7 @@ static int	unify_key(ukey_state *state, word key ARG_LD);
 static void	init_ukey_state(ukey_state *state, trie *trie, Word p);
 static void	destroy_ukey_state(ukey_state *state);
 static void	set_trie_clause_general_undefined(Clause cl);
+static void	reclaim_retired(trie *trie, int all);
 
 
 		 /*******************************
@@ -235,10 +247,12 @@ trie_empty(trie *trie)
   { indirect_table *it = trie->indirects;
 
     clear_node(trie, &trie->root, FALSE);	/* TBD: verify not accessed */
+    reclaim_retired(trie, TRUE);
     if ( it && COMPARE_AND_SWAP(&trie->indirects, it, NULL) )
       destroy_indirect_table(it);
     trie->node_count = 1;
     trie->value_count = 0;
+    trie->consumers = 0;
   }
 }
 
@@ -247,6 +261,250 @@ void
 trie_clean(trie *trie)
 { if ( trie->magic == TRIE_CMAGIC )
     trie_empty(trie);
+  else if ( trie->retired )
+    reclaim_retired(trie, FALSE);
+}
+
+
+		 /*******************************
+		 *	  CHILDREN ARRAYS	*
+		 *******************************/
+
+static trie_children_array *
+new_children_array(trie *trie, unsigned size)
+{ trie_children_array *a;
+
+  if ( (a=alloc_from_pool(trie->alloc_pool, SIZEOF_TN_ARRAY(size))) )
+  { memset(a, 0, SIZEOF_TN_ARRAY(size));
+    a->type = TN_ARRAY;
+    a->size = size;
+  }
+
+  return a;
+}
+
+
+static void
+free_children_array(trie *trie, trie_children_array *a)
+{ free_to_pool(trie->alloc_pool, a, SIZEOF_TN_ARRAY(a->size));
+}
+
+
+		 /*******************************
+		 *	     RECLAIMING		*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Safe reclamation of trie nodes and children blocks. Code that walks over
+the nodes of a trie  brackets  the   walk  in  enter_trie_access()  and
+leave_trie_access(). The outermost call  publishes   the  global generation
+at which the thread started accessing tries.  Unlinked objects are added
+to a local list by  the  operation   that  unlinks  them (a prune or an
+insert). When the operation is completed  the   list  is stamped with a
+single new global generation and added   to  trie->retired. They are
+freed if no thread accesses tries from a generation older than that.
+
+The published generation is per thread  rather   than  per trie. As for
+clauses, a thread that leaves a trie_gen/3  choicepoint open thus delays
+reclamation of the nodes retired after   the  choicepoint was created in
+_all_ tries. These are freed by the  first reclaim of the trie after the
+choicepoint is closed, i.e., after the   next TRIE_RECLAIM_BATCH retired
+objects or if the trie is emptied.  A published generation of 0 means
+"not accessing", which is safe as the generation is incremented
+many times while booting.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define TRIE_RECLAIM_BATCH 64		/* Try reclaiming after N retires */
+
+typedef enum
+{ TR_NODE,				/* trie_node */
+  TR_KEY,				/* trie_children_key */
+  TR_ARRAY				/* trie_children_array */
+} tr_object_type;
+
+typedef struct trie_retired
+{ struct trie_retired *next;		/* Next retired object */
+  gen_t		generation;		/* Generation it was retired */
+  tr_object_type type;			/* TR_* */
+  void	       *object;			/* The retired object */
+} trie_retired;
+
+#ifdef O_PLMT
+#define TRIE_ACCESS_GENERATION (LD->thread.info->access.trie_generation)
+#else
+#define TRIE_ACCESS_GENERATION (LD->tries.generation)
+#endif
+
+#define enter_trie_access() enter_trie_access__LD(PASS_LD1)
+#define leave_trie_access() leave_trie_access__LD(PASS_LD1)
+
+static inline void
+enter_trie_access__LD(ARG1_LD)
+{ if ( LD->tries.accessing++ == 0 )
+  { gen_t gen;
+
+    do
+    { gen = global_generation();
+      TRIE_ACCESS_GENERATION = gen;
+      MemoryBarrier();
+    } while( gen != global_generation() );
+  }
+}
+
+static inline void
+leave_trie_access__LD(ARG1_LD)
+{ if ( --LD->tries.accessing == 0 )
+    TRIE_ACCESS_GENERATION = 0;
+}
+
+
+static void
+free_retired(trie *trie, trie_retired *r)
+{ switch(r->type)
+  { case TR_NODE:
+      destroy_node(trie, r->object);
+      break;
+    case TR_KEY:
+      free_to_pool(trie->alloc_pool, r->object, sizeof(trie_children_key));
+      break;
+    case TR_ARRAY:
+      free_children_array(trie, r->object);
+      break;
+  }
+
+  freeHeap(r, sizeof(*r));
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Free the retired objects that are no longer accessible. If `all` is TRUE
+we free all of them, which is used when the trie is emptied and thus no
+longer accessed.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+reclaim_retired(trie *trie, int all)
+{ trie_retired *r;
+
+  if ( (r=trie->retired) && COMPARE_AND_SWAP(&trie->retired, r, NULL) )
+  { gen_t oldest = all ? GEN_MAX : oldest_trie_access_generation();
+    trie_retired *keep = NULL, *last = NULL, *next;
+
+    for(; r; r=next)
+    { next = r->next;
+
+      if ( r->generation <= oldest )
+      { free_retired(trie, r);
+      } else
+      { r->next = keep;
+	keep = r;
+	if ( !last )
+	  last = r;
+      }
+    }
+
+    if ( keep )
+    { do
+      { last->next = trie->retired;
+      } while( !COMPARE_AND_SWAP(&trie->retired, last->next, keep) );
+    }
+  }
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+retire_object() adds an unlinked object   to  the operation's local list
+`*batch`. retire_objects() stamps the list with   one  new generation and
+adds it to the trie. The generation must be  allocated after the last
+object is unlinked, so  threads  that   publish  this  generation cannot
+have seen any of the objects.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+retire_object(trie_retired **batch, tr_object_type type, void *obj)
+{ trie_retired *r = allocHeapOrHalt(sizeof(*r));
+
+  r->type   = type;
+  r->object = obj;
+  r->next   = *batch;
+  *batch    = r;
+}
+
+
+static void
+retire_objects(trie *trie, trie_retired *batch)
+{ if ( batch )
+  { gen_t gen = next_global_generation();
+    trie_retired *last;
+    unsigned int count = 1;
+
+    for(last=batch; ; last=last->next)
+    { last->generation = gen;
+      if ( !last->next )
+	break;
+      count++;
+    }
+
+    do
+    { last->next = trie->retired;
+    } while( !COMPARE_AND_SWAP(&trie->retired, last->next, batch) );
+
+    if ( ATOMIC_ADD(&trie->retired_count, count) >= TRIE_RECLAIM_BATCH )
+    { trie->retired_count = 0;
+      reclaim_retired(trie, FALSE);
+    }
+  }
+}
+
+#define retire_children_array(b, a) retire_object(b, TR_ARRAY, a)
+#define retire_children_key(b, k)   retire_object(b, TR_KEY, k)
+#define retire_node(b, n)	    retire_object(b, TR_NODE, n)
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Find the index of key in a  TN_ARRAY   node  or  return -1. The array is
+terminated by the first 0 key. Using  SSE2   we  compare two keys at the
+time, using the 32-bit compare and combining the two halves.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static inline int
+array_key_index(const trie_children_array *a, word key)
+{ const word *keys = a->keys;
+  unsigned i;
+
+#ifdef O_TRIE_SSE2
+  __m128i k = _mm_set1_epi64x((int64_t)key);
+
+  for(i=0; i<a->size; i+=2)
+  { __m128i v  = _mm_loadu_si128((const __m128i*)&keys[i]);
+    __m128i eq = _mm_cmpeq_epi32(v, k);
+    int mask;
+
+    eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2,3,0,1)));
+    if ( (mask=_mm_movemask_pd(_mm_castsi128_pd(eq))) )
+      return i + ((mask&0x1) ? 0 : 1);
+    if ( !keys[i+1] )
+      break;
+  }
+#else
+  for(i=0; i<a->size && keys[i]; i++)
+  { if ( keys[i] == key )
+      return i;
+  }
+#endif
+
+  return -1;
+}
+
+
+static inline unsigned
+array_child_count(const trie_children_array *a)
+{ unsigned i;
+
+  for(i=0; i<a->size && a->keys[i]; i++)
+    ;
+
+  return i;
 }
 
 
@@ -260,6 +518,11 @@ get_child(trie_node *n, word key ARG_LD)
 	if ( children.key->key == key )
 	  return children.key->child;
         return NULL;
+      case TN_ARRAY:
+      { int i = array_key_index(children.array, key);
+
+	return i < 0 ? NULL : TN_ARRAY_CHILDREN(children.array)[i];
+      }
       case TN_HASHED:
 	return lookupHTable(children.hash->table, (void*)key);
       default:
@@ -315,6 +578,18 @@ next:
 	dealloc = TRUE;
 	goto next;
       }
+      case TN_ARRAY:
+      { trie_children_array *a = children.array;
+	trie_node **kids = TN_ARRAY_CHILDREN(a);
+	unsigned i, count = array_child_count(a);
+
+	for(i=0; i<count; i++)
+	{ if ( kids[i] )
+	    clear_node(trie, kids[i], TRUE);
+	}
+	free_children_array(trie, a);
+	break;
+      }
       case TN_HASHED:
       { Table table = children.hash->table;
 	TableEnum e = newTableEnum(table);
@@ -343,15 +618,54 @@ destroy_node(trie *trie, trie_node *n)
 /*
  * Prune a branch of the trie that does not end in a node.  This should
  * be used after deletion or unsuccessful insertion, e.g., by trying to
- * insert a cyclic term
+ * insert a cyclic term.  The unlinked nodes are retired together in a
+ * single generation, so concurrent readers may still walk them.
  *
- * TBD: Need to think about concurrency here.
+ * TBD: Concurrent insertion into the pruned path may be lost.
  */
 
+static int
+prune_array_child(trie *trie, trie_node *p, trie_node *n,
+		  trie_retired **batch)
+{ for(;;)
+  { trie_children_array *a = p->children.array;
+    trie_node **kids = TN_ARRAY_CHILDREN(a);
+    trie_children_array *new;
+    unsigned i, j, count = array_child_count(a);
+
+    if ( count <= 1 )
+    { if ( COMPARE_AND_SWAP(&p->children.array, a, NULL) )
+      { retire_children_array(batch, a);
+	return TRUE;
+      }
+      continue;
+    }
+
+    if ( !(new = new_children_array(trie, a->size)) )
+      return -1;
+    for(i=0, j=0; i<count; i++)
+    { if ( kids[i] != n )
+      { new->keys[j] = a->keys[i];
+	TN_ARRAY_CHILDREN(new)[j] = kids[i];
+	j++;
+      }
+    }
+    new->var_mask = a->var_mask;
+
+    if ( COMPARE_AND_SWAP(&p->children.array, a, new) )
+    { retire_children_array(batch, a);
+      return FALSE;
+    }
+    free_children_array(trie, new);
+  }
+}
+
+
 void
 prune_node(trie *trie, trie_node *n)
 { trie_node *p;
   int empty = TRUE;
+  trie_retired *batch = NULL;
 
   for(; empty && n->parent; n = p)
   { trie_children children;
@@ -363,7 +677,13 @@ prune_node(trie *trie, trie_node *n)
     { switch( children.any->type )
       { case TN_KEY:
 	  if ( COMPARE_AND_SWAP(&p->children.any, children.any, NULL) )
-	    PL_free(children.any);
+	    retire_children_key(&batch, children.key);
+	  break;
+	case TN_ARRAY:
+	  if ( (empty = prune_array_child(trie, p, n, &batch)) < 0 )
+	  { retire_objects(trie, batch);
+	    return;			/* no memory; leave the empty branch */
+	  }
 	  break;
 	case TN_HASHED:
 	  deleteHTable(children.hash->table, (void*)n->key);
@@ -372,8 +692,10 @@ prune_node(trie *trie, trie_node *n)
       }
     }
 
-    destroy_node(trie, n);
+    retire_node(&batch, n);
   }
+
+  retire_objects(trie, batch);
 }
 
 
@@ -381,7 +703,7 @@ prune_node(trie *trie, trie_node *n)
 #define VMASK_SCAN (0x1<<(VMASKBITS-1))
 
 static inline void
-update_var_mask(trie_children_hashed *hnode, word key)
+update_var_mask(unsigned *var_mask, word key)
 { if ( tagex(key) == TAG_VAR )
   { size_t vn = (size_t)(key>>LMASK_BITS); /* 1.. */
     unsigned mask;
@@ -391,7 +713,69 @@ update_var_mask(trie_children_hashed *hnode, word key)
     else
       mask = VMASK_SCAN;
 
-    ATOMIC_OR(&hnode->var_mask, mask);
+    ATOMIC_OR(var_mask, mask);
+  }
+}
+
+
+static void
+add_array_child(trie_children_array *a, unsigned i, word key, trie_node *child)
+{ a->keys[i] = key;
+  TN_ARRAY_CHILDREN(a)[i] = child;
+  update_var_mask(&a->var_mask, key);
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Create the children representation for a full array of children plus
+`new`: an array of double the size or, if the array has its maximum
+size, a hash table.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+grow_children(trie *trie, trie_children_array *a, trie_node *new,
+	      trie_children *grown)
+{ trie_node **kids = TN_ARRAY_CHILDREN(a);
+  unsigned i;
+
+  if ( a->size < TN_ARRAY_MAX )
+  { trie_children_array *b;
+
+    if ( !(b=new_children_array(trie, a->size*2)) )
+      return FALSE;
+    for(i=0; i<a->size; i++)
+      add_array_child(b, i, a->keys[i], kids[i]);
+    add_array_child(b, i, new->key, new);
+    grown->array = b;
+  } else
+  { trie_children_hashed *hnode;
+
+    if ( !(hnode=alloc_from_pool(trie->alloc_pool, sizeof(*hnode))) )
+      return FALSE;
+
+    hnode->type     = TN_HASHED;
+    hnode->table    = newHTable(TN_ARRAY_MAX*2);
+    hnode->var_mask = 0;
+    for(i=0; i<a->size; i++)
+    { addHTable(hnode->table, (void*)a->keys[i], kids[i]);
+      update_var_mask(&hnode->var_mask, a->keys[i]);
+    }
+    addHTable(hnode->table, (void*)new->key, new);
+    update_var_mask(&hnode->var_mask, new->key);
+    grown->hash = hnode;
+  }
+
+  return TRUE;
+}
+
+
+static void
+free_grown_children(trie *trie, trie_children grown)
+{ if ( grown.any->type == TN_ARRAY )
+  { free_children_array(trie, grown.array);
+  } else
+  { destroyHTable(grown.hash->table);
+    free_to_pool(trie->alloc_pool, grown.hash, sizeof(*grown.hash));
   }
 }
 
@@ -409,35 +793,83 @@ insert_child(trie *trie, trie_node *n, word key ARG_LD)
     { switch( children.any->type )
       { case TN_KEY:
 	{ if ( children.key->key == key )
-	  { return children.key->child;
+	  { destroy_node(trie, new);
+	    return children.key->child;
 	  } else
-	  { trie_children_hashed *hnode;
+	  { trie_children_array *anode;
 
-	    if ( !(hnode=alloc_from_pool(trie->alloc_pool, sizeof(*hnode))) )
+	    if ( !(anode=new_children_array(trie, TN_ARRAY_MIN)) )
 	    { destroy_node(trie, new);
 	      return NULL;
 	    }
 
-	    hnode->type     = TN_HASHED;
-	    hnode->table    = newHTable(4);
-	    hnode->var_mask = 0;
-	    addHTable(hnode->table, (void*)children.key->key,
-				    children.key->child);
-	    addHTable(hnode->table, (void*)key, (void*)new);
-	    update_var_mask(hnode, children.key->key);
-	    update_var_mask(hnode, new->key);
-
-	    if ( COMPARE_AND_SWAP(&n->children.hash, children.hash, hnode) )
-	    {					/* TBD: Safely free */
-	      free_to_pool(trie->alloc_pool, children.any, sizeof(trie_children_key));
-	      new->parent = n;
+	    add_array_child(anode, 0, children.key->key, children.key->child);
+	    add_array_child(anode, 1, key, new);
+	    new->parent = n;
+
+	    if ( COMPARE_AND_SWAP(&n->children.array, children.array, anode) )
+	    { trie_retired *batch = NULL;
+
+	      retire_children_key(&batch, children.key);
+	      retire_objects(trie, batch);
 	      return new;
 	    }
 	    destroy_node(trie, new);
-	    destroyHTable(hnode->table);
-	    free_to_pool(trie->alloc_pool, hnode, sizeof(*hnode));
+	    free_children_array(trie, anode);
+	    continue;
+	  }
+	}
+	case TN_ARRAY:
+	{ trie_children_array *a = children.array;
+	  trie_node **kids = TN_ARRAY_CHILDREN(a);
+	  trie_children grown;
+	  unsigned i;
+
+	  new->parent = n;
+	  for(i=0; i<a->size; i++)
+	  { word k = a->keys[i];
+
+	    if ( !k )
+	    { if ( COMPARE_AND_SWAP(&a->keys[i], 0, key) )
+	      { update_var_mask(&a->var_mask, key);
+		kids[i] = new;
+		return new;
+	      }
+	      k = a->keys[i];
+	    }
+	    if ( k == key )
+	    { trie_node *child;
+
+	      while( !(child=kids[i]) )	/* being added by another thread */
+		MemoryBarrier();
+	      destroy_node(trie, new);
+	      return child;
+	    }
+	  }
+
+	  for(i=0; i<a->size; i++)	/* wait for pending additions */
+	  { if ( !kids[i] )
+	      break;
+	  }
+	  if ( i < a->size )
+	  { destroy_node(trie, new);
 	    continue;
 	  }
+
+	  if ( !grow_children(trie, a, new, &grown) )
+	  { destroy_node(trie, new);
+	    return NULL;
+	  }
+	  if ( COMPARE_AND_SWAP(&n->children.any, children.any, grown.any) )
+	  { trie_retired *batch = NULL;
+
+	    retire_children_array(&batch, a);
+	    retire_objects(trie, batch);
+	    return new;
+	  }
+	  destroy_node(trie, new);
+	  free_grown_children(trie, grown);
+	  continue;
 	}
 	case TN_HASHED:
 	{ trie_node *old = addHTable(children.hash->table,
@@ -445,7 +877,7 @@ insert_child(trie *trie, trie_node *n, word key ARG_LD)
 
 	  if ( new == old )
 	  { new->parent = n;
-	    update_var_mask(children.hash, new->key);
+	    update_var_mask(&children.hash->var_mask, new->key);
 	  } else
 	  { destroy_node(trie, new);
 	  }
@@ -532,6 +964,7 @@ trie_lookup(trie *trie, trie_node **nodep, Word k, int add, TmpBuffer vars ARG_L
 
   TRIE_STAT_INC(trie, lookups);
 
+  enter_trie_access();
   initTermAgenda_P(&agenda, 1, k);
   while( node )
   { Word p;
@@ -598,6 +1031,7 @@ trie_lookup(trie *trie, trie_node **nodep, Word k, int add, TmpBuffer vars ARG_L
     }
   }
   clearTermAgenda_P(&agenda);
+  leave_trie_access();
 
   if ( var_number )
   { Word *pp = baseBuffer(vars, Word);
@@ -716,9 +1150,9 @@ out:
 }
 
 
-void *
-map_trie_node(trie_node *n,
-	      void* (*map)(trie_node *n, void *ctx), void *ctx)
+static void *
+map_trie_node_(trie_node *n,
+	       void* (*map)(trie_node *n, void *ctx), void *ctx)
 { trie_children children;
   void *rc;
 
@@ -734,13 +1168,24 @@ next:
       { n = children.key->child;
 	goto next;
       }
+      case TN_ARRAY:
+      { trie_children_array *a = children.array;
+	trie_node **kids = TN_ARRAY_CHILDREN(a);
+	unsigned i, count = array_child_count(a);
+
+	for(i=0; i<count; i++)
+	{ if ( kids[i] && (rc=map_trie_node_(kids[i], map, ctx)) != NULL )
+	    return rc;
+	}
+	break;
+      }
       case TN_HASHED:
       { Table table = children.hash->table;
 	TableEnum e = newTableEnum(table);
 	void *k, *v;
 
 	while(advanceTableEnum(e, &k, &v))
-	{ if ( (rc=map_trie_node(v, map, ctx)) != NULL )
+	{ if ( (rc=map_trie_node_(v, map, ctx)) != NULL )
 	  { freeTableEnum(e);
 	    return rc;
 	  }
@@ -756,6 +1201,20 @@ next:
 }
 
 
+void *
+map_trie_node(trie_node *n,
+	      void* (*map)(trie_node *n, void *ctx), void *ctx)
+{ GET_LD
+  void *rc;
+
+  enter_trie_access();
+  rc = map_trie_node_(n, map, ctx);
+  leave_trie_access();
+
+  return rc;
+}
+
+
 typedef struct trie_stats
 { size_t bytes;
   size_t nodes;
@@ -779,6 +1238,9 @@ stat_node(trie_node *n, void *ctx)
     { case TN_KEY:
 	stats->bytes += sizeof(*children.key);
         break;
+      case TN_ARRAY:
+	stats->bytes += SIZEOF_TN_ARRAY(children.array->size);
+	break;
       case TN_HASHED:
 	stats->bytes += sizeofTable(children.hash->table);
 	stats->hashes++;
@@ -1055,31 +1517,28 @@ set_trie_value(trie *trie, trie_node *node, term_t value ARG_LD)
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Delete a node from the trie. There are   two options: (1) simply set the
 value to 0 or (2), prune the branch   leading to this cell upwards until
-we find another existing node.
-
-TBD: create some sort of  lingering   mechanism  to allow for concurrent
-delete and gen_trie(). More modest: link up the deleted nodes and remove
-them after the references drop to 0.
+we find another existing node.   The  value  is  released immediately.
+Pruned nodes are retired (see   retire_object()),  which  makes pruning
+safe while other threads or trie_gen/3  choicepoints walk the trie.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 void
 trie_delete(trie *trie, trie_node *node, int prune)
-{ if ( node->value )
-  { if ( prune && trie->references == 0 )
-    { prune_node(trie, node);
-    } else
-    { word v;
+{ word v;
 
-      if ( trie->release_node )
-	(*trie->release_node)(trie, node);
+  if ( node->value )
+  { if ( trie->release_node )
+      (*trie->release_node)(trie, node);
 
-      if ( (v=node->value) )
-      { node->value = 0;
-	release_value(v);
-      }
+    if ( (v=node->value) )
+    { node->value = 0;
+      release_value(v);
     }
     ATOMIC_DEC(&trie->value_count);
     trie_discard_clause(trie);
+
+    if ( prune )
+      prune_node(trie, node);
   }
 }
 
@@ -1537,6 +1996,8 @@ unify_key(ukey_state *state, word key ARG_LD)
 typedef struct trie_choice
 { TableEnum  table_enum;
   Table      table;
+  trie_children_array *array;
+  unsigned   array_index;
   unsigned   var_mask;
   unsigned   var_index;
   word       novar;
@@ -1579,7 +2040,7 @@ init_trie_state(trie_gen_state *state, trie *trie)
 
 
 static void
-clear_trie_state(trie_gen_state *state)
+clear_trie_state(trie_gen_state *state ARG_LD)
 { trie_choice *chp = base_choice(state);
   trie_choice *top = top_choice(state);
 
@@ -1590,6 +2051,7 @@ clear_trie_state(trie_gen_state *state)
 
   discardBuffer(&state->choicepoints);
 
+  leave_trie_access();
   release_trie(state->trie);
 
   if ( state->allocated )
@@ -1695,6 +2157,7 @@ add_choice(trie_gen_state *state, descent_state *dstate, trie_node *node ARG_LD)
 	  ch->child      = children.key->child;
 	  ch->table_enum = NULL;
 	  ch->table      = NULL;
+	  ch->array      = NULL;
 
 	  if ( IS_TRIE_KEY_POP(children.key->key) && dstate->compound )
 	  { desc_tstate dts;
@@ -1709,6 +2172,40 @@ add_choice(trie_gen_state *state, descent_state *dstate, trie_node *node ARG_LD)
 	{ DEBUG(MSG_TRIE_GEN, Sdprintf("Failed\n"));
 	  return NULL;
 	}
+      case TN_ARRAY:
+      { trie_children_array *a = children.array;
+
+	if ( has_key && a->var_mask == 0 )
+	{ int i = array_key_index(a, k);
+	  trie_node *child;
+
+	  if ( i >= 0 && (child=TN_ARRAY_CHILDREN(a)[i]) )
+	  { ch = allocFromBuffer(&state->choicepoints, sizeof(*ch));
+	    ch->key        = k;
+	    ch->child      = child;
+	    ch->table_enum = NULL;
+	    ch->table      = NULL;
+	    ch->array      = NULL;
+
+	    return ch;
+	  } else
+	    return NULL;
+	}
+					/* enumerate (matching) keys */
+	dstate->prune = FALSE;
+	ch = allocFromBuffer(&state->choicepoints, sizeof(*ch));
+	ch->table_enum  = NULL;
+	ch->table       = NULL;
+	ch->array       = a;
+	ch->array_index = 0;
+	ch->novar       = has_key ? k : 0;
+	if ( advance_node(ch PASS_LD) )
+	{ return ch;
+	} else
+	{ state->choicepoints.top = (char*)ch;
+	  return NULL;
+	}
+      }
       case TN_HASHED:
       { void *tk, *tv;
 
@@ -1722,6 +2219,7 @@ add_choice(trie_gen_state *state, descent_state *dstate, trie_node *node ARG_LD)
 	      ch->child	     = child;
 	      ch->table_enum = NULL;
 	      ch->table      = NULL;
+	      ch->array      = NULL;
 
 	      return ch;
 	    } else
@@ -1735,6 +2233,7 @@ add_choice(trie_gen_state *state, descent_state *dstate, trie_node *node ARG_LD)
 	    ch = allocFromBuffer(&state->choicepoints, sizeof(*ch));
 	    ch->table_enum = NULL;
 	    ch->table      = children.hash->table;
+	    ch->array      = NULL;
 	    ch->var_mask   = children.hash->var_mask;
 	    ch->var_index  = 1;
 	    ch->novar      = k;
@@ -1751,8 +2250,13 @@ add_choice(trie_gen_state *state, descent_state *dstate, trie_node *node ARG_LD)
 	dstate->prune = FALSE;
 	ch = allocFromBuffer(&state->choicepoints, sizeof(*ch));
 	ch->table = NULL;
+	ch->array = NULL;
 	ch->table_enum = newTableEnum(children.hash->table);
-	advanceTableEnum(ch->table_enum, &tk, &tv);
+	if ( !advanceTableEnum(ch->table_enum, &tk, &tv) )
+	{ freeTableEnum(ch->table_enum);	/* emptied by a concurrent prune */
+	  state->choicepoints.top = (char*)ch;
+	  return NULL;
+	}
 	ch->key   = (word)tk;
 	ch->child = (trie_node*)tv;
 	break;
@@ -1811,6 +2315,26 @@ advance_node(trie_choice *ch ARG_LD)
 	}
       }
     }
+  } else if ( ch->array )
+  { trie_children_array *a = ch->array;
+    trie_node **kids = TN_ARRAY_CHILDREN(a);
+
+    for( ; ch->array_index < a->size; ch->array_index++ )
+    { word key = a->keys[ch->array_index];
+      trie_node *child;
+
+      if ( !key )
+	break;
+      if ( !(child=kids[ch->array_index]) )
+	continue;
+      if ( ch->novar && key != ch->novar && tagex(key) != TAG_VAR )
+	continue;
+
+      ch->key   = key;
+      ch->child = child;
+      ch->array_index++;
+      return TRUE;
+    }
   }
 
   return FALSE;
@@ -1824,7 +2348,13 @@ next_choice0(trie_gen_state *state, descent_state *dstate ARG_LD)
 
   while(ch >= btm)
   { if ( advance_node(ch PASS_LD) )
-      return descent_node(state, dstate, ch PASS_LD);
+    { trie_choice *dch;
+
+      if ( (dch=descent_node(state, dstate, ch PASS_LD)) )
+	return dch;
+      ch = top_choice(state)-1;		/* branch was pruned concurrently */
+      continue;
+    }
 
     if ( ch->table_enum )
       freeTableEnum(ch->table_enum);
@@ -1917,6 +2447,7 @@ trie_gen(term_t Trie, term_t Key, term_t Value,
 	  deRef(dstate.term);
 
 	  acquire_trie(trie);
+	  enter_trie_access();
 	  state = &state_buf;
 	  init_trie_state(state, trie);
 	  rc = ( (ch = add_choice(state, &dstate, &trie->root PASS_LD)) &&
@@ -1924,7 +2455,7 @@ trie_gen(term_t Trie, term_t Key, term_t Value,
 		 (ch->child->value || next_choice(state PASS_LD)) );
 	  clear_descent_state(&dstate);
 	  if ( !rc )
-	  { clear_trie_state(state);
+	  { clear_trie_state(state PASS_LD);
 	    return FALSE;
 	  }
 	  break;
@@ -1938,12 +2469,12 @@ trie_gen(term_t Trie, term_t Key, term_t Value,
 	   next_choice(state PASS_LD) )		/* pending choice was deleted */
       { break;
       } else
-      { clear_trie_state(state);
+      { clear_trie_state(state PASS_LD);
 	return FALSE;
       }
     case FRG_CUTTED:
       state = CTX_PTR;
-      clear_trie_state(state);
+      clear_trie_state(state PASS_LD);
       return TRUE;
     default:
       assert(0);
@@ -1967,7 +2498,7 @@ trie_gen(term_t Trie, term_t Key, term_t Value,
       if ( makeMoreStackSpace(rc, ALLOW_GC|ALLOW_SHIFT) )
 	continue;
 
-      clear_trie_state(state);
+      clear_trie_state(state PASS_LD);
       return FALSE;				/* resource error */
     }
 
@@ -1998,7 +2529,7 @@ trie_gen(term_t Trie, term_t Key, term_t Value,
 	}
 	ForeignRedoPtr(state);
       } else
-      { clear_trie_state(state);
+      { clear_trie_state(state PASS_LD);
 	return TRUE;
       }
     } else
@@ -2008,7 +2539,7 @@ trie_gen(term_t Trie, term_t Key, term_t Value,
 next:;
   }
 
-  clear_trie_state(state);
+  clear_trie_state(state PASS_LD);
   return FALSE;
 }
 
@@ -2047,12 +2578,20 @@ PRED_IMPL("$trie_property", 2, trie_property, 0)
   static atom_t ATOM_gen_call_count = 0;
   static atom_t ATOM_invalidated = 0;
   static atom_t ATOM_reevaluated = 0;
-
-  if ( !ATOM_lookup_count )
-  { ATOM_lookup_count   = PL_new_atom("lookup_count");
-    ATOM_gen_call_count = PL_new_atom("gen_call_count");
-    ATOM_invalidated    = PL_new_atom("invalidated");
-    ATOM_reevaluated    = PL_new_atom("reevaluated");
+  static atom_t ATOM_answer_count = 0;
+  static atom_t ATOM_duplicate_count = 0;
+  static atom_t ATOM_suspension_count = 0;
+  static atom_t ATOM_completion_time = 0;
+
+  if ( !ATOM_completion_time )
+  { ATOM_lookup_count      = PL_new_atom("lookup_count");
+    ATOM_gen_call_count    = PL_new_atom("gen_call_count");
+    ATOM_invalidated       = PL_new_atom("invalidated");
+    ATOM_reevaluated       = PL_new_atom("reevaluated");
+    ATOM_answer_count      = PL_new_atom("answer_count");
+    ATOM_duplicate_count   = PL_new_atom("duplicate_count");
+    ATOM_suspension_count  = PL_new_atom("suspension_count");
+    ATOM_completion_time   = PL_new_atom("completion_time");
   }
 #endif
 
@@ -2104,6 +2643,14 @@ PRED_IMPL("$trie_property", 2, trie_property, 0)
       { return PL_unify_int64(arg, idg->stats.invalidated);
       } else if ( name == ATOM_reevaluated && (idg=trie->data.IDG))
       { return PL_unify_int64(arg, idg->stats.reevaluated);
+      } else if ( name == ATOM_answer_count )
+      { return PL_unify_int64(arg, trie->stats.answers);
+      } else if ( name == ATOM_duplicate_count )
+      { return PL_unify_int64(arg, trie->stats.duplicate_answers);
+      } else if ( name == ATOM_suspension_count )
+      { return PL_unify_int64(arg, trie->stats.suspensions);
+      } else if ( name == ATOM_completion_time )
+      { return PL_unify_float(arg, trie->stats.completion_time);
 #endif
       }
     }
@@ -2410,6 +2957,26 @@ children:
 	n = children.key->child;
 	goto next;
       }
+      case TN_ARRAY:
+      { trie_children_array *a = children.array;
+	trie_node **kids = TN_ARRAY_CHILDREN(a);
+	unsigned i, count;
+
+	for(count=0; count<a->size && a->keys[count] && kids[count]; count++)
+	  ;
+	if ( count == 0 )
+	  return TRUE;				/* empty path */
+
+	for(i=0; i+1<count; i++)
+	{ state->try = TRUE;
+	  if ( (rc=compile_trie_node(kids[i], state PASS_LD)) != TRUE )
+	    return rc;
+	  fixup_else(state);
+	}
+	state->try = FALSE;
+	n = kids[i];
+	goto next;
+      }
       case TN_HASHED:
       { Table table = children.hash->table;
 	TableEnum e = newTableEnum(table);
@@ -2515,11 +3082,14 @@ retry:
     { trie_compile_state state;
       Clause cl;
       ClauseRef cref;
+      int rc;
 
       init_trie_compile_state(&state, trie);
       add_vmi(&state, def->functor->arity == 2 ? T_TRIE_GEN2 : T_TRIE_GEN3);
-      if ( compile_trie_node(&trie->root, &state PASS_LD) &&
-	   create_trie_clause(def, &cl, &state) )
+      enter_trie_access();
+      rc = compile_trie_node(&trie->root, &state PASS_LD);
+      leave_trie_access();
+      if ( rc && create_trie_clause(def, &cl, &state) )
       { cref = assertDefinition(def, cl, CL_END PASS_LD);
 	if ( cref )
 	{ dbref = lookup_clref(cref->value.clause);
@@ -2539,6 +3109,46 @@ retry:
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Decide whether a consumer of a   complete answer trie should enumerate
+the trie directly rather  than  compiling  it.   Compilation  only pays
+off if the answers are enumerated several times, so we only compile after
+the trie has been enumerated  the  number   of  times  specified by the
+Prolog flag `table_compile_threshold`.  This also  avoids stalling the
+first consumer of a huge table on compiling it.
+
+Only answer tries are deferred.   User   tries  are always compiled as
+trie_gen_compiled/2,3 is documented to enumerate   a snapshot that is
+immune to concurrent modifications.
+
+Shared tables are always compiled as the clause is shared by all threads
+and provides thread-safe enumeration while the table is abolished.  The
+same holds for tables that are  abolished   on  completion  and tables in
+the IDG, whose answer trie may be  modified by re-evaluation while it is
+being enumerated.
+
+If `consume` is TRUE, the caller  is   going  to enumerate the trie and
+this call counts as a consumer.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+int
+trie_compile_deferred(trie *trie, int consume ARG_LD)
+{ if ( trie->clause ||
+       !(true(trie, TRIE_COMPLETE) || trie->data.worklist) ||
+       true(trie, TRIE_ISSHARED|TRIE_ABOLISH_ON_COMPLETE) ||
+       trie->data.IDG )
+    return FALSE;
+
+  if ( trie->consumers < LD->tabling.compile_threshold )
+  { if ( consume )
+      ATOMIC_INC(&trie->consumers);
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+
 static
 PRED_IMPL("$trie_compile", 2, trie_compile, 0)
 { PRED_LD
@@ -2649,4 +3259,9 @@ initTries(void)
   set(def, P_LOCKED_SUPERVISOR|P_VOLATILE);
   def->codes = SUPERVISOR(trie_gen);
   GD->procedures.trie_gen_compiled3 = proc;
+
+  GD->procedures.tbl_answer_update_dl2 =
+	PL_predicate("$tbl_answer_update_dl", 2, "system");
+  GD->procedures.tbl_answer_update_dl3 =
+	PL_predicate("$tbl_answer_update_dl", 3, "system");
 }
@@ -46,9 +46,13 @@
 
 typedef enum
 { TN_KEY,				/* Single key */
+  TN_ARRAY,				/* Small array of keys */
   TN_HASHED				/* Hashed */
 } tn_node_type;
 
+#define TN_ARRAY_MIN 4			/* Initial size of a TN_ARRAY */
+#define TN_ARRAY_MAX 16			/* Use a hash table beyond this */
+
 typedef struct try_children_any
 { tn_node_type type;
 } try_children_any;
@@ -65,9 +69,22 @@ typedef struct trie_children_key
   struct trie_node *child;
 } trie_children_key;
 
+typedef struct trie_children_array
+{ tn_node_type	type;			/* TN_ARRAY */
+  unsigned	size;			/* Allocated slots */
+  unsigned	var_mask;		/* Variables in this place */
+  word		keys[1];		/* size keys, followed by size children */
+} trie_children_array;
+
+#define TN_ARRAY_CHILDREN(a) ((struct trie_node**)&(a)->keys[(a)->size])
+#define SIZEOF_TN_ARRAY(n) \
+	(offsetof(trie_children_array, keys) + \
+	 (n)*(sizeof(word)+sizeof(struct trie_node*)))
+
 typedef union trie_children
 { try_children_any     *any;
   trie_children_key    *key;
+  trie_children_array  *array;
   trie_children_hashed *hash;
 } trie_children;
 
@@ -117,11 +134,18 @@ typedef struct trie
   indirect_table       *indirects;	/* indirect values */
   void		      (*release_node)(struct trie *, trie_node *);
   trie_allocation_pool *alloc_pool;	/* Node allocation pool */
+  struct trie_retired  *retired;	/* Unlinked, waiting to be freed */
+  unsigned int		retired_count;	/* # objects retired since reclaim */
   atom_t		clause;		/* Compiled representation */
+  unsigned int		consumers;	/* # uncompiled answer enumerations */
 #ifdef O_TRIE_STATS
   struct
   { uint64_t		lookups;	/* trie_lookup */
     uint64_t		gen_call;	/* trie_gen calls */
+    uint64_t		answers;	/* # answers added by tabling */
+    uint64_t		duplicate_answers; /* # answers that were not new */
+    uint64_t		suspensions;	/* # suspensions added */
+    double		completion_time; /* Wall time to complete the table */
   } stats;
 #endif
   struct
@@ -136,6 +160,8 @@ typedef struct trie
 			       trie_clean(t); \
 			   } while(0)
 
+#define TRIE_COMPILE_THRESHOLD 1	/* default table_compile_threshold flag */
+
 #define TRIE_ARGS	3
 #define TRIE_VAR_OFFSET (TRIE_ARGS+3)
 
@@ -172,6 +198,7 @@ COMMON(foreign_t) trie_gen(term_t Trie, term_t Key, term_t Value,
 COMMON(void *)	map_trie_node(trie_node *n,
 			      void* (*map)(trie_node *n, void *ctx), void *ctx);
 COMMON(atom_t)	compile_trie(Definition def, trie *trie ARG_LD);
+COMMON(int)	trie_compile_deferred(trie *trie, int consume ARG_LD);
 COMMON(void *)	alloc_from_pool(trie_allocation_pool *pool, size_t bytes);
 COMMON(void)	free_to_pool(trie_allocation_pool *pool, void *mem, size_t bytes);
 
@@ -5136,6 +5136,15 @@ predicate.
 Instead of passing a trie we can also   pass  the dbref for the compiled
 trie clause or `fail` to express the  trie   is  empty.  This is used to
 achieve thread-safe deletion of answer tries.
+
+If trie_compile_deferred() tells us compilation   does not (yet) pay off
+we continue as $tbl_answer_update_dl/2,3, which enumerates the trie
+directly.
+
+The compiled clause of a trie is   shared by trie_gen_compiled/2 and /3.
+It is compiled for /3 if the trie  is   a  map, such that it produces the
+values.  T_TRIE_GEN3 provides a  dummy  value   argument  if  it is
+called through trie_gen_compiled/2.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 VMI(S_TRIE_GEN, 0, 0, ())
@@ -5164,14 +5173,45 @@ VMI(S_TRIE_GEN, 0, 0, ())
     if ( !(t = symbol_trie(dbref)) )
       goto trie_gen_type_error;
 
-    TRIE_STAT_INC(t, gen_call);
     if ( !(dbref=t->clause) )
     { if ( t->value_count == 0 )
 	FRAME_FAILED;
 
-      SAVE_REGISTERS(qid);
-      dbref = compile_trie(FR->predicate, t PASS_LD);
-      LOAD_REGISTERS(qid);
+      if ( trie_compile_deferred(t, TRUE PASS_LD) )
+      { Procedure proc = ( DEF->functor->arity == 2
+			     ? GD->procedures.tbl_answer_update_dl2
+			     : GD->procedures.tbl_answer_update_dl3 );
+
+	DEF = proc->definition;
+	setFramePredicate(FR, DEF);
+	setGenerationFrame(FR);
+	PC = DEF->codes;
+	NEXT_INSTRUCTION;
+      }
+
+      { fid_t fid;
+
+	TRIE_STAT_INC(t, gen_call);
+	lTop = (LocalFrame)argFrameP(FR, DEF->functor->arity);
+	SAVE_REGISTERS(qid);
+	if ( (fid = PL_open_foreign_frame()) )
+	{ dbref = compile_trie(true(t, TRIE_ISMAP)
+			       ? GD->procedures.trie_gen_compiled3->definition
+			       : GD->procedures.trie_gen_compiled2->definition,
+			       t PASS_LD);
+	  PL_close_foreign_frame(fid);
+	} else
+	{ dbref = 0;
+	}
+	LOAD_REGISTERS(qid);
+	if ( !dbref )
+	{ if ( exception_term )
+	    THROW_EXCEPTION;
+	  FRAME_FAILED;
+	}
+      }
+    } else
+    { TRIE_STAT_INC(t, gen_call);
     }
 
     if ( dbref == ATOM_fail )
@@ -5300,6 +5340,8 @@ VMI(T_TRIE_GEN3, 0, 0, ())
 
   DEBUG(MSG_TRIE_VM, Sdprintf("T_TRIE_GEN: %zd vars\n", nvars));
 
+  if ( FR->predicate->functor->arity == 2 )
+    setVar(argFrame(FR, 2));		/* called as trie_gen_compiled/2 */
   *TrieTermP     = ATOM_nil;
   *TrieOffset    = consInt(1);
   *TrieArgStackP = ATOM_nil;
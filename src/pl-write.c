@@ -212,26 +212,24 @@ truePrologFlagNoLD(unsigned int flag)
 }
 
 
+#define AC_VARPREFIX	0x1		/* atomTypeContext() context */
+#define AC_DOTINATOM	0x2
+#define AC_BQSYMBOL	0x4
+
 static inline int
-wr_is_symbol(int c, write_options *options)
-{ return ( isSymbol(c) ||
-	   (c == '`' &&
-	    options &&
-	    (options->flags & PL_WRT_BACKQUOTE_IS_SYMBOL)) );
+wr_is_symbol(int c, int ctx)
+{ return ( isSymbol(c) || (c == '`' && (ctx&AC_BQSYMBOL)) );
 }
 
 static int
-atomType(atom_t a, write_options *options)
-{ Atom atom = atomValue(a);
-  char *s = atom->name;
+atomTypeContext(Atom atom, IOSTREAM *fd, int ctx)
+{ char *s = atom->name;
   size_t len = atom->length;
-  IOSTREAM *fd = options ? options->out : NULL;
-  Module m = options ? options->module : MODULE_user;
 
   if ( len == 0 )
     return AT_QUOTE;
 
-  if ( isLower(*s) || (true(m, M_VARPREFIX) && isAlpha(*s)) )
+  if ( isLower(*s) || ((ctx&AC_VARPREFIX) && isAlpha(*s)) )
   { do
     { for( ++s;
 	   --len > 0 && isAlpha(*s) && (!fd || Scanrepresent(*s, fd)==0);
@@ -239,14 +237,13 @@ atomType(atom_t a, write_options *options)
 	;
     } while ( len >= 2 &&
 	      *s == '.' && isAlpha(s[1]) &&
-	      truePrologFlagNoLD(PLFLAG_DOT_IN_ATOM) &&
-	      (!options || false(options, PL_WRT_NODOTINATOM))
+	      (ctx&AC_DOTINATOM)
 	    );
 
     return len == 0 ? AT_LOWER : AT_QUOTE;
   }
 
-  if ( wr_is_symbol(*s, options) )
+  if ( wr_is_symbol(*s, ctx) )
   { size_t left = len;
 
     if ( len == 1 && s[0] == '.' )
@@ -255,7 +252,7 @@ atomType(atom_t a, write_options *options)
       return AT_QUOTE;
 
     for( ;
-	 left > 0 && wr_is_symbol(*s, options) &&
+	 left > 0 && wr_is_symbol(*s, ctx) &&
 	 (!fd || Scanrepresent(*s, fd)==0);
 	 s++, left--)
       ;
@@ -271,13 +268,92 @@ atomType(atom_t a, write_options *options)
       return AT_SOLO;
   }
 
-  if ( a == ATOM_nil || a == ATOM_curl )
+  if ( atom->atom == ATOM_nil || atom->atom == ATOM_curl )
     return AT_SPECIAL;
 
   return AT_QUOTE;
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+atomType() caches the classification of  an   atom  in the context-free
+case  (no  var_prefix,  no  dot_in_atom,    no  backquote_is_symbol  and
+representable on any stream) in atom->write_flags. Along with it we keep
+whether the text contains a `.`, a  backquote or non-ASCII characters, so
+we can decide whether the context can   change  the result. If so, the
+atom is classified again. As the text of an atom never changes, the cache
+needs no invalidation. Atom-GC resets write_flags on reuse.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define AT_TYPE_MASK	0x0f
+#define AT_CACHED	0x10		/* write_flags is valid */
+#define AT_HAS_DOT	0x20		/* text contains a . */
+#define AT_HAS_BQ	0x40		/* text contains a ` */
+#define AT_NON_ASCII	0x80		/* text contains chars > 0x7f */
+
+static unsigned int
+atomWriteFlags(Atom atom)
+{ const unsigned char *s = (const unsigned char *)atom->name;
+  const unsigned char *e = s+atom->length;
+  unsigned int flags = AT_CACHED|atomTypeContext(atom, NULL, 0);
+
+  for( ; s < e; s++ )
+  { if ( *s == '.' )
+      flags |= AT_HAS_DOT;
+    else if ( *s == '`' )
+      flags |= AT_HAS_BQ;
+    else if ( *s > 0x7f )
+      flags |= AT_NON_ASCII;
+  }
+
+  return flags;
+}
+
+
+static int
+representsLatin1(IOSTREAM *fd)
+{ switch(fd->encoding)
+  { case ENC_OCTET:
+    case ENC_ISO_LATIN_1:
+    case ENC_UTF8:
+    case ENC_UNICODE_BE:
+    case ENC_UNICODE_LE:
+    case ENC_WCHAR:
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
+
+
+static int
+atomType(atom_t a, write_options *options)
+{ Atom atom = atomValue(a);
+  IOSTREAM *fd = options ? options->out : NULL;
+  Module m = options ? options->module : MODULE_user;
+  unsigned int flags = atom->write_flags;
+  int ctx = 0;
+
+  if ( !(flags&AT_CACHED) )
+    atom->write_flags = flags = atomWriteFlags(atom);
+
+  if ( (flags&AT_HAS_DOT) &&
+       truePrologFlagNoLD(PLFLAG_DOT_IN_ATOM) &&
+       (!options || false(options, PL_WRT_NODOTINATOM)) )
+    ctx |= AC_DOTINATOM;
+  if ( (flags&AT_HAS_BQ) &&
+       options && (options->flags & PL_WRT_BACKQUOTE_IS_SYMBOL) )
+    ctx |= AC_BQSYMBOL;
+  if ( true(m, M_VARPREFIX) )
+    ctx |= AC_VARPREFIX;
+
+  if ( ctx || ((flags&AT_NON_ASCII) && fd && !representsLatin1(fd)) )
+    return atomTypeContext(atom, fd, ctx);
+
+  return flags&AT_TYPE_MASK;
+}
+
+
 static int
 unquoted_atomW(atom_t atom, IOSTREAM *fd, int flags)
 { Atom ap = atomValue(atom);
@@ -344,14 +420,7 @@ Putc(int c, IOSTREAM *s)
 
 static bool
 PutString(const char *str, IOSTREAM *s)
-{ const unsigned char *q = (const unsigned char *)str;
-
-  for( ; *q != EOS; q++ )
-  { if ( Sputcode(*q, s) == EOF )
-      return FALSE;
-  }
-
-  return TRUE;
+{ return Sfputs(str, s) == EOF ? FALSE : TRUE;
 }
 
 
@@ -375,15 +444,7 @@ PutBar(write_options *options)
 
 static bool
 PutStringN(const char *str, size_t length, IOSTREAM *s)
-{ size_t i;
-  const unsigned char *q = (const unsigned char *)str;
-
-  for(i=0; i<length; i++, q++)
-  { if ( Sputcode(*q, s) == EOF )
-      return FALSE;
-  }
-
-  return TRUE;
+{ return Sfputsn(str, length, s) == EOF ? FALSE : TRUE;
 }
 
 
@@ -563,15 +624,34 @@ putQuoted(int c, int quote, int flags, IOSTREAM *stream)
 
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+writeQuoted() writes ISO Latin-1 text between quotes.  Printable ASCII
+other than the quote and the backslash is never escaped, so runs of
+such characters are emitted as a whole using PutStringN().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define isPlainQuoted(c, q) ((c) >= ' ' && (c) <= '~' && \
+			     (c) != (q) && (c) != '\\')
+
 static bool
 writeQuoted(IOSTREAM *stream, const char *text, size_t len, int quote,
 	    write_options *options)
 { const unsigned char *s = (const unsigned char *)text;
+  const unsigned char *e = s+len;
 
   TRY(Putc(quote, stream));
 
-  while(len-- > 0)
-  { TRY(putQuoted(*s++, quote, options->flags, stream));
+  while(s < e)
+  { const unsigned char *r = s;
+
+    while( r < e && isPlainQuoted(*r, quote) )
+      r++;
+    if ( r > s )
+    { TRY(PutStringN((const char *)s, r-s, stream));
+      s = r;
+    } else
+    { TRY(putQuoted(*s++, quote, options->flags, stream));
+    }
   }
 
   return Putc(quote, stream);
@@ -825,6 +905,10 @@ writeString(term_t t, write_options *options)
     else
       quote = '"';
 
+    if ( txt.encoding == ENC_ISO_LATIN_1 )
+      return writeQuoted(options->out, txt.text.t, txt.length, quote,
+			 options);
+
     TRY(Putc(quote, options->out));
 
     for(i=0; i<txt.length; i++)
@@ -837,6 +921,9 @@ writeString(term_t t, write_options *options)
   } else
   { unsigned int i;
 
+    if ( txt.encoding == ENC_ISO_LATIN_1 )
+      return PutStringN(txt.text.t, txt.length, options->out);
+
     for(i=0; i<txt.length; i++)
     { int chr = get_chr_from_text(&txt, i);
 
@@ -1016,11 +1103,13 @@ char *
 format_float(double f, char *buf)
 { char *end, *o=buf, *s;
   int decpt, sign;
+  char digits[FAST_DTOA_BUFSIZE];
 
   if ( (s=format_special_float(f, buf)) )
     return s;
 
-  s = dtoa(f, 0, 30, &decpt, &sign, &end);
+  if ( !(s = fast_dtoa(f, digits, &decpt, &sign, &end)) )
+    s = dtoa(f, 0, 30, &decpt, &sign, &end);
   DEBUG(2, Sdprintf("decpt=%d, sign=%d, len = %d, '%s'\n",
 		    decpt, sign, end-s, s));
 
@@ -1079,7 +1168,8 @@ format_float(double f, char *buf)
     }
   }
 
-  freedtoa(s);
+  if ( s != digits )
+    freedtoa(s);
 
   return buf;
 }
@@ -1312,6 +1402,9 @@ writeArgTerm(term_t t, int prec, write_options *options, bool arg)
   int levelSave = options->depth;
   fid_t fid;
 
+  if ( !options->max_depth && PL_is_atomic(t) )
+    return writeTerm2(t, prec, options, arg);	/* no frame needed */
+
   if ( !(fid = PL_open_foreign_frame()) )
     return FALSE;
 
@@ -58,6 +58,8 @@ typedef enum zipper_input
 /* flags */
 #define ZIP_RELEASE_ON_CLOSE		0x0001
 #define ZIP_CLOSE_STREAM_ON_CLOSE	0x0002
+#define ZIP_MAPPED			0x0004	/* input is a private file map */
+#define ZIP_MAPPED_ENTRY		0x0008	/* entry is read from the map */
 
 typedef struct zipper
 { atom_t	 symbol;			/* <zipper>(address) blob */